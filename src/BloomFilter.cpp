@@ -1,62 +1,30 @@
 #include "BloomFilter.h"
+#include <algorithm>
 
 BloomFilter::BloomFilter(uint64_t size, uint8_t numHashes)
-      : m_bits(size),
-        m_numHashes(numHashes) { m_compressedData = new unsigned char[size]; }
-       
-BloomFilter::~BloomFilter(){// and do not forget to delete it later
-delete[] m_compressedData;}
-
-std::array<uint64_t, 2> hash(const uint8_t *data, std::size_t len) {
-  std::array<uint64_t, 2> hashValue;
-  MurmurHash3_x64_128(data, len, 0, hashValue.data());
-
-  return hashValue;
-}
-
-inline uint64_t nthHash(uint8_t n,
-                        uint64_t hashA,
-                        uint64_t hashB,
-                        uint64_t filterSize) {
-    return (hashA + n * hashB) % filterSize;
-}
+      : m_size(size),
+        m_numHashes(numHashes),
+        m_words((size + 63) / 64, 0) {}
 
 void BloomFilter::add(const uint8_t *data, std::size_t len) {
-  
-  auto hashValues = hash(data, len);
-  
-  //tests
-   if(WRITE_TESTS){
-    std::ofstream outfile;
-    outfile.open("test_1_sec_lvl_"+std::to_string(SECURITY_LEVEL)+".csv", std::ios::out | std::ios::app );
-    outfile << "\n Time taken to hash element for B.F. in nanoseconds \n";
-    for (int i=0; i<505; i++)
-    {
-          auto start = std::chrono::high_resolution_clock::now();
-          auto hashValues = hash(data, len);
-          auto elapsed = std::chrono::high_resolution_clock::now() - start;
-          long long nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
-        //  printf("\n Time taken to add/map element in B.F. : %lld nanoseconds\n\n",  nanoseconds);
-          
-          // write inputted data into the file.
-          outfile << nanoseconds << ", ";
-                  
-    }
-    // close the opened file.
-    outfile.close();
-  }
-  
+  addHashed(hash(data, len));
+}
 
+void BloomFilter::addHashed(const std::array<uint64_t, 2> &hashValues) {
   for (int n = 0; n < m_numHashes; n++) {
-      m_bits[nthHash(n, hashValues[0], hashValues[1], m_bits.size())] = true;
+      uint64_t i = nthHash(n, hashValues[0], hashValues[1], m_size);
+      m_words[i >> 6] |= 1ULL << (i & 63);
   }
 }
 
 bool BloomFilter::possiblyContains(const uint8_t *data, std::size_t len) const {
-  auto hashValues = hash(data, len);
+  return containsHashed(hash(data, len));
+}
 
+bool BloomFilter::containsHashed(const std::array<uint64_t, 2> &hashValues) const {
   for (int n = 0; n < m_numHashes; n++) {
-      if (!m_bits[nthHash(n, hashValues[0], hashValues[1], m_bits.size())]) {
+      uint64_t i = nthHash(n, hashValues[0], hashValues[1], m_size);
+      if (!((m_words[i >> 6] >> (i & 63)) & 1)) {
           return false;
       }
   }
@@ -66,10 +34,10 @@ bool BloomFilter::possiblyContains(const uint8_t *data, std::size_t len) const {
 
 
 std::string BloomFilter::get_string() {
-    std::string ret = "";
-    for ( bool bit : m_bits ) {
-        unsigned int vOut = bit?1:0;
-        ret += std::to_string(vOut);
+    std::string ret(m_size, '0');
+    for (uint64_t i = 0; i < m_size; i++) {
+        if ((m_words[i >> 6] >> (i & 63)) & 1)
+            ret[i] = '1';
     }
     return ret;
 }
@@ -78,17 +46,50 @@ void BloomFilter::to_bits(std::string input) {
 
   std::string temp = input;
 
-  if (temp.length()> m_bits.size()){
+  if (temp.length()> m_size){
     printf("Error: input length greater than B.F. size");
     return;
   }
-	for (int i = 0; i < temp.length(); i++) {
-        bool vOut = (temp[i]=='1')?true:false;
-        m_bits[i] = vOut;
+  std::fill(m_words.begin(), m_words.end(), 0);
+	for (uint64_t i = 0; i < temp.length(); i++) {
+        if (temp[i]=='1')
+            m_words[i >> 6] |= 1ULL << (i & 63);
 	}
   return;  
 }
 
+bool BloomFilter::compatible(const BloomFilter &other) const {
+  if (m_size != other.m_size || m_numHashes != other.m_numHashes) {
+    printf("Error: B.F. size or number of hashes differ");
+    return false;
+  }
+  return true;
+}
+
+bool BloomFilter::unite(const BloomFilter &other) {
+  if (!compatible(other))
+    return false;
+  for (std::size_t i = 0; i < m_words.size(); i++)
+    m_words[i] |= other.m_words[i];
+  return true;
+}
+
+bool BloomFilter::intersect(const BloomFilter &other) {
+  if (!compatible(other))
+    return false;
+  for (std::size_t i = 0; i < m_words.size(); i++)
+    m_words[i] &= other.m_words[i];
+  return true;
+}
+
+uint64_t BloomFilter::popcount() const {
+  return ::popcount(m_words.data(), m_words.size());
+}
+
+double BloomFilter::estimateCardinality() const {
+  return ::estimateCardinality(m_size, m_numHashes, popcount());
+}
+
 //ARITHMETIC COMPRESSION FUNCTIONS (FUTURE WORK, ADD COMPRESSION)
 /*
 // - - Constants - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
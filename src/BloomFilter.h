@@ -1,28 +1,84 @@
+#pragma once
 #include <vector>
 #include <bitset>
 #include <cstdint> 
 #include <array>
 #include <string>
-#include <chrono>
+#include <cmath>
 #include <stdlib.h>
 #include "FastAC_fix-nh/FastAC/arithmetic_codec.h"
 #include <iostream>
-#include <fstream>
 #include "smhasher-master/src/MurmurHash3.h"
-#ifndef SECURITY_LEVEL
-  #define SECURITY_LEVEL 1
-#endif
-#define WRITE_TESTS false
+#include "MurmurHash3Stream.h"
+
+/*
+ * Hash policies: Hash::hash(data, len) returns a 128-bit digest as the two 64-bit
+ * halves used for double hashing. City and Spooky policies are in HashPolicy.h.
+ */
+struct Murmur3Hash {
+  //incremental form over fragments, same digest as hash() of their concatenation
+  typedef MurmurHash3Stream Stream;
+
+  static inline std::array<uint64_t, 2> hash(const uint8_t *data, std::size_t len) {
+    std::array<uint64_t, 2> hashValue;
+    MurmurHash3_x64_128(data, len, 0, hashValue.data());
+
+    return hashValue;
+  }
+};
+
+//hash of the CAESAR filters and of the receiver's message digest, both ends must agree
+typedef Murmur3Hash CaesarHash;
+
+inline std::array<uint64_t, 2> hash(const uint8_t *data, std::size_t len) {
+  return CaesarHash::hash(data, len);
+}
+
+inline uint64_t nthHash(uint8_t n,
+                        uint64_t hashA,
+                        uint64_t hashB,
+                        uint64_t filterSize) {
+    return (hashA + n * hashB) % filterSize;
+}
+
+inline uint64_t popcount(const uint64_t *words, std::size_t numWords) {
+  uint64_t count = 0;
+  for (std::size_t i = 0; i < numWords; i++)
+    count += __builtin_popcountll(words[i]);
+  return count;
+}
+
+/*
+ * Swamidass & Baldi estimate of the number of distinct elements in a B.F. of
+ * size bits with numHashes hashes and setBits bits set.
+ */
+inline double estimateCardinality(uint64_t size, uint8_t numHashes, uint64_t setBits) {
+  if (setBits >= size)
+    return INFINITY;
+  return -((double)size / numHashes) * log1p(-(double)setBits / size);
+}
 
 struct BloomFilter {
   BloomFilter(uint64_t size, uint8_t numHashes);
-  ~BloomFilter();
   
   void add(const uint8_t *data, std::size_t len);
   bool possiblyContains(const uint8_t *data, std::size_t len) const;
 
+  //take a precomputed hash(data, len) so a message is only hashed once
+  void addHashed(const std::array<uint64_t, 2> &hashValues);
+  bool containsHashed(const std::array<uint64_t, 2> &hashValues) const;
+
   std::string get_string();
   void to_bits(std::string input);
+
+  //word-wise set algebra, both filters must have the same size and number of hashes
+  bool unite(const BloomFilter &other);
+  bool intersect(const BloomFilter &other);
+  uint64_t popcount() const;
+  double estimateCardinality() const;
+
+  uint64_t size() const { return m_size; }
+  uint8_t numHashes() const { return m_numHashes; }
   
   /* FUTURE WORK
   int Encode_BloomFilter(int);
@@ -30,7 +86,106 @@ struct BloomFilter {
   */
 
 private:
+  bool compatible(const BloomFilter &other) const;
+
+  uint64_t m_size;
   uint8_t m_numHashes;
-  unsigned char *m_compressedData;
-  std::vector<bool> m_bits;
+  std::vector<uint64_t> m_words;
+};
+
+/*
+ * Probe loop of StaticBloomFilter, unrolled at compile time for K hashes.
+ */
+template <uint8_t N>
+struct BloomProbe {
+  template <std::size_t Bits, std::size_t Words>
+  static inline void set(std::array<uint64_t, Words> &words, uint64_t hashA, uint64_t hashB) {
+    BloomProbe<N - 1>::template set<Bits>(words, hashA, hashB);
+    uint64_t i = nthHash(N - 1, hashA, hashB, Bits);
+    words[i >> 6] |= 1ULL << (i & 63);
+  }
+
+  template <std::size_t Bits, std::size_t Words>
+  static inline bool test(const std::array<uint64_t, Words> &words, uint64_t hashA, uint64_t hashB) {
+    uint64_t i = nthHash(N - 1, hashA, hashB, Bits);
+    return BloomProbe<N - 1>::template test<Bits>(words, hashA, hashB) & ((words[i >> 6] >> (i & 63)) & 1);
+  }
+};
+
+template <>
+struct BloomProbe<0> {
+  template <std::size_t Bits, std::size_t Words>
+  static inline void set(std::array<uint64_t, Words> &, uint64_t, uint64_t) {}
+
+  template <std::size_t Bits, std::size_t Words>
+  static inline bool test(const std::array<uint64_t, Words> &, uint64_t, uint64_t) { return true; }
+};
+
+/*
+ * Bloom filter with size and number of hashes fixed at compile time, storage is inline.
+ * Bit layout and hashing match BloomFilter, so both serialize to the same string
+ * when Hash is CaesarHash.
+ */
+template <std::size_t Bits, uint8_t K, class Hash = CaesarHash>
+struct StaticBloomFilter {
+  static constexpr std::size_t size = Bits;
+  static constexpr uint8_t numHashes = K;
+
+  void add(const uint8_t *data, std::size_t len) {
+    addHashed(Hash::hash(data, len));
+  }
+
+  bool possiblyContains(const uint8_t *data, std::size_t len) const {
+    return containsHashed(Hash::hash(data, len));
+  }
+
+  void addHashed(const std::array<uint64_t, 2> &hashValues) {
+    BloomProbe<K>::template set<Bits>(m_words, hashValues[0], hashValues[1]);
+  }
+
+  bool containsHashed(const std::array<uint64_t, 2> &hashValues) const {
+    return BloomProbe<K>::template test<Bits>(m_words, hashValues[0], hashValues[1]);
+  }
+
+  std::string get_string() const {
+    std::string ret(Bits, '0');
+    for (std::size_t i = 0; i < Bits; i++) {
+      if ((m_words[i >> 6] >> (i & 63)) & 1)
+        ret[i] = '1';
+    }
+    return ret;
+  }
+
+  void to_bits(std::string input) {
+    if (input.length() > Bits) {
+      printf("Error: input length greater than B.F. size");
+      return;
+    }
+    m_words.fill(0);
+    for (std::size_t i = 0; i < input.length(); i++) {
+      if (input[i] == '1')
+        m_words[i >> 6] |= 1ULL << (i & 63);
+    }
+  }
+
+  void unite(const StaticBloomFilter &other) {
+    for (std::size_t i = 0; i < m_words.size(); i++)
+      m_words[i] |= other.m_words[i];
+  }
+
+  void intersect(const StaticBloomFilter &other) {
+    for (std::size_t i = 0; i < m_words.size(); i++)
+      m_words[i] &= other.m_words[i];
+  }
+
+  uint64_t popcount() const {
+    return ::popcount(m_words.data(), m_words.size());
+  }
+
+  double estimateCardinality() const {
+    return ::estimateCardinality(Bits, K, popcount());
+  }
+
+private:
+  std::array<uint64_t, (Bits + 63) / 64> m_words{};
 };
\ No newline at end of file
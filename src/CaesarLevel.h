@@ -0,0 +1,109 @@
+/*
+  CaesarLevel.h
+  @Description: Compile-time parameters of the AIS_CAESAR security levels, shared by the
+  transmitter, the receiver and the simulation tools
+**/
+#pragma once
+#include "BloomFilter.h"
+#include "XorFilter.h"
+
+#define MAX_SLOTS 3
+#define MAX_SLOTS_DATA_SIZE 66
+
+/***********************************************************
+ *                                                         *
+ *              Security level parameters                  *
+ *                                                         *
+ * *********************************************************/
+
+/**
+ *  @brief Compile-time CAESAR parameters of a security level
+ *  B.F. size z takes what is left of the slots after key, MAC and app meta bits, or a
+ *  whole message when sent separately. k is the (truncated) log(2) * z/N that both
+ *  ends used to compute at runtime, so filters stay wire compatible.
+ */
+template <int OutputDigestSize, int NumberOfMessages, bool HasFilter, bool SeparateFilter>
+struct CaesarLevelParams {
+  static constexpr int key_size = 16;
+  static constexpr int application_meta_size = 1;
+  static constexpr int output_digest_size = OutputDigestSize;
+  static constexpr int number_of_messages = NumberOfMessages;
+  static constexpr bool separate_filter = SeparateFilter;
+  static constexpr int filter_bytes = !HasFilter ? 0 :
+      SeparateFilter ? MAX_SLOTS_DATA_SIZE - application_meta_size
+                     : MAX_SLOTS_DATA_SIZE - (output_digest_size + key_size + application_meta_size);
+  static constexpr int filter_bits = filter_bytes * 8;
+  static constexpr int num_hashes = (int)(0.6931471805599453 * (filter_bytes / number_of_messages));
+
+  typedef StaticBloomFilter<filter_bits, num_hashes> Filter;
+  static Filter make_filter() { return Filter(); }
+};
+
+//HMAC input digest is SHA512 at every level, truncated to output_digest_size bytes
+template <int Level> struct CaesarLevel;
+template <> struct CaesarLevel<0> : CaesarLevelParams<49, 1, false, false> {};
+template <> struct CaesarLevel<1> : CaesarLevelParams<49, 1, false, false> {};  //TESLA only, 512 bits digest size
+template <> struct CaesarLevel<2> : CaesarLevelParams<21, 1, false, false> {};  //TESLA only, 160 bits digest size
+template <> struct CaesarLevel<3> : CaesarLevelParams<32, 2, true, false> {};   //TESLA + B.F. in same message, 256 bits digest size
+template <> struct CaesarLevel<4> : CaesarLevelParams<20, 4, true, false> {};   //TESLA + B.F. in same message, 160 bits digest size
+template <> struct CaesarLevel<5> : CaesarLevelParams<20, 9, true, true> {};    //TESLA + B.F. (2 slots) in sep. message, 160 bits digest size
+template <> struct CaesarLevel<6> : CaesarLevelParams<49, 9, true, true> {};    //TESLA + B.F. (3 slots) in sep. message, 512 bits digest size
+template <> struct CaesarLevel<7> : CaesarLevelParams<20, 9, true, true> {      //TESLA + Xor filter (1 slot) in sep. message, 160 bits digest size
+  typedef XorFilter Filter;
+  static Filter make_filter() { return XorFilter(number_of_messages); }
+};
+
+/**
+ *  @brief Call f with the CaesarLevel of a security level only known at runtime, the one place
+ *  where a level number is mapped to its parameters
+ *  @param int level
+ *  @param F &&f functor with a template <class L> operator()(L), called with CaesarLevel<level>()
+ *  @return false if the level is not supported (f is not called)
+ */
+template <class F>
+bool caesar_level_dispatch(int level, F &&f)
+{
+  switch (level) {
+    case 0: f(CaesarLevel<0>()); return true;
+    case 1: f(CaesarLevel<1>()); return true;
+    case 2: f(CaesarLevel<2>()); return true;
+    case 3: f(CaesarLevel<3>()); return true;
+    case 4: f(CaesarLevel<4>()); return true;
+    case 5: f(CaesarLevel<5>()); return true;
+    case 6: f(CaesarLevel<6>()); return true;
+    case 7: f(CaesarLevel<7>()); return true;
+    default: return false;
+  }
+}
+
+/**
+ *  @brief Parameters of a security level only known at runtime
+ */
+struct CaesarLevelConfig {
+  int key_size;
+  int output_digest_size;
+  int number_of_messages;           //AIS type 4 messages per TESLA message
+  bool has_filter;
+};
+
+//fills a CaesarLevelConfig from the CaesarLevel it is called with
+struct CaesarLevelConfigReader {
+  CaesarLevelConfig &config;
+  template <class L> void operator()(L) const {
+    config.key_size = L::key_size;
+    config.output_digest_size = L::output_digest_size;
+    config.number_of_messages = L::number_of_messages;
+    config.has_filter = L::filter_bits > 0;
+  }
+};
+
+/**
+ *  @brief Runtime parameters of a security level
+ *  @param int level
+ *  @param CaesarLevelConfig &config
+ *  @return false if the level is not supported
+ */
+inline bool caesar_level_config(int level, CaesarLevelConfig &config)
+{
+  return caesar_level_dispatch(level, CaesarLevelConfigReader{config});
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include "smhasher-master/src/City.h"
+#include "smhasher-master/src/Spooky.h"
+
+/*
+ * CityHash128 and SpookyHash128 policies for StaticBloomFilter, same interface as
+ * Murmur3Hash in BloomFilter.h. Kept apart because Spooky.h pulls in smhasher's
+ * Platform.h helpers. Link smhasher-master/src/City.cpp and Spooky.cpp when used.
+ */
+struct City128Hash {
+  static inline std::array<uint64_t, 2> hash(const uint8_t *data, std::size_t len) {
+    uint128 h = CityHash128((const char *)data, len);
+    std::array<uint64_t, 2> hashValue = {{h.first, h.second}};
+
+    return hashValue;
+  }
+};
+
+struct Spooky128Hash {
+  static inline std::array<uint64_t, 2> hash(const uint8_t *data, std::size_t len) {
+    uint64 h1 = 0, h2 = 0;
+    SpookyHash::Hash128(data, len, &h1, &h2);
+    std::array<uint64_t, 2> hashValue = {{h1, h2}};
+
+    return hashValue;
+  }
+};
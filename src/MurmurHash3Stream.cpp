@@ -0,0 +1,112 @@
+#include "MurmurHash3Stream.h"
+#include <string.h>
+
+static const uint64_t c1 = 0x87c37b91114253d5ULL;
+static const uint64_t c2 = 0x4cf5ad432745937fULL;
+
+static inline uint64_t rotl64(uint64_t x, int8_t r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t fmix64(uint64_t k) {
+  k ^= k >> 33;
+  k *= 0xff51afd7ed558ccdULL;
+  k ^= k >> 33;
+  k *= 0xc4ceb9fe1a85ec53ULL;
+  k ^= k >> 33;
+  return k;
+}
+
+MurmurHash3Stream::MurmurHash3Stream(uint32_t seed) {
+  reset(seed);
+}
+
+void MurmurHash3Stream::reset(uint32_t seed) {
+  m_h1 = seed;
+  m_h2 = seed;
+  m_length = 0;
+  m_tailLength = 0;
+}
+
+void MurmurHash3Stream::block(uint64_t k1, uint64_t k2) {
+  k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; m_h1 ^= k1;
+
+  m_h1 = rotl64(m_h1, 27); m_h1 += m_h2; m_h1 = m_h1 * 5 + 0x52dce729;
+
+  k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; m_h2 ^= k2;
+
+  m_h2 = rotl64(m_h2, 31); m_h2 += m_h1; m_h2 = m_h2 * 5 + 0x38495ab5;
+}
+
+void MurmurHash3Stream::process(const void *data, std::size_t len) {
+  const uint8_t *p = (const uint8_t *)data;
+  m_length += len;
+
+  //complete the block left over by the previous fragment
+  if (m_tailLength > 0) {
+    std::size_t n = 16 - m_tailLength;
+    if (n > len)
+      n = len;
+    memcpy(m_tail + m_tailLength, p, n);
+    m_tailLength += n;
+    p += n;
+    len -= n;
+    if (m_tailLength < 16)
+      return;
+    uint64_t k[2];
+    memcpy(k, m_tail, 16);
+    block(k[0], k[1]);
+    m_tailLength = 0;
+  }
+
+  //whole blocks straight from the fragment, native byte order as in MurmurHash3_x64_128
+  for (; len >= 16; p += 16, len -= 16) {
+    uint64_t k[2];
+    memcpy(k, p, 16);
+    block(k[0], k[1]);
+  }
+
+  memcpy(m_tail, p, len);
+  m_tailLength = len;
+}
+
+std::array<uint64_t, 2> MurmurHash3Stream::result() const {
+  uint64_t h1 = m_h1, h2 = m_h2;
+  uint64_t k1 = 0, k2 = 0;
+  const uint8_t *tail = m_tail;
+
+  switch (m_tailLength) {
+  case 15: k2 ^= ((uint64_t)tail[14]) << 48;
+  case 14: k2 ^= ((uint64_t)tail[13]) << 40;
+  case 13: k2 ^= ((uint64_t)tail[12]) << 32;
+  case 12: k2 ^= ((uint64_t)tail[11]) << 24;
+  case 11: k2 ^= ((uint64_t)tail[10]) << 16;
+  case 10: k2 ^= ((uint64_t)tail[ 9]) << 8;
+  case  9: k2 ^= ((uint64_t)tail[ 8]) << 0;
+           k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+
+  case  8: k1 ^= ((uint64_t)tail[ 7]) << 56;
+  case  7: k1 ^= ((uint64_t)tail[ 6]) << 48;
+  case  6: k1 ^= ((uint64_t)tail[ 5]) << 40;
+  case  5: k1 ^= ((uint64_t)tail[ 4]) << 32;
+  case  4: k1 ^= ((uint64_t)tail[ 3]) << 24;
+  case  3: k1 ^= ((uint64_t)tail[ 2]) << 16;
+  case  2: k1 ^= ((uint64_t)tail[ 1]) << 8;
+  case  1: k1 ^= ((uint64_t)tail[ 0]) << 0;
+           k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+  };
+
+  h1 ^= m_length; h2 ^= m_length;
+
+  h1 += h2;
+  h2 += h1;
+
+  h1 = fmix64(h1);
+  h2 = fmix64(h2);
+
+  h1 += h2;
+  h2 += h1;
+
+  std::array<uint64_t, 2> hashValue = {{h1, h2}};
+  return hashValue;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <cstdint>
+#include <stddef.h>
+#include <array>
+
+/*
+ * Incremental MurmurHash3_x64_128, in the spirit of PMurHash32_Process for the 32-bit
+ * variant. Fragments are absorbed as they arrive and result() equals MurmurHash3_x64_128
+ * of their concatenation, so a reassembled payload can be hashed without building it.
+ * At most 15 bytes of a partial block are carried between process() calls.
+ */
+struct MurmurHash3Stream {
+  MurmurHash3Stream(uint32_t seed = 0);
+
+  void process(const void *data, std::size_t len);
+  std::array<uint64_t, 2> result() const;
+
+  void reset(uint32_t seed = 0);
+
+private:
+  void block(uint64_t k1, uint64_t k2);
+
+  uint64_t m_h1;
+  uint64_t m_h2;
+  uint64_t m_length;
+  uint8_t m_tail[16];
+  uint8_t m_tailLength;
+};
@@ -0,0 +1,90 @@
+#include "ReplayFilter.h"
+#include <algorithm>
+
+#define REPLAY_MAX_HASHES 32
+
+ReplayFilter::ReplayFilter(uint32_t numPartitions, uint32_t slotsPerPartition, uint64_t partitionBits, uint8_t numHashes)
+      : m_numPartitions(std::max(2u, numPartitions)),
+        m_slotsPerPartition(std::max(1u, slotsPerPartition)),
+        m_partitionBits(std::max((uint64_t)64, partitionBits)),
+        m_partitionWords((m_partitionBits + 63) / 64),
+        m_numHashes(std::min(std::max((int)numHashes, 1), REPLAY_MAX_HASHES)),
+        m_current(0),
+        m_slot(0),
+        m_now(0),
+        m_started(false),
+        m_words(m_numPartitions * m_partitionWords, 0) {}
+
+void ReplayFilter::positions(const std::array<uint64_t, 2> &digest, uint32_t mmsi, uint64_t *out) const {
+  //the MMSI is mixed in so identical payloads of different vessels do not collide,
+  //an odd hashB keeps the probes distinct for power of two partitions
+  uint64_t hashA = digest[0] ^ (mmsi * 0x9e3779b97f4a7c15ULL);
+  uint64_t hashB = digest[1] | 1;
+  for (int n = 0; n < m_numHashes; n++)
+    out[n] = nthHash(n, hashA, hashB, m_partitionBits);
+}
+
+bool ReplayFilter::test(uint32_t partition, const uint64_t *pos) const {
+  const uint64_t *words = &m_words[partition * m_partitionWords];
+  for (int n = 0; n < m_numHashes; n++) {
+    if (!((words[pos[n] >> 6] >> (pos[n] & 63)) & 1))
+      return false;
+  }
+  return true;
+}
+
+bool ReplayFilter::possiblyContains(const std::array<uint64_t, 2> &digest, uint32_t mmsi) const {
+  uint64_t pos[REPLAY_MAX_HASHES];
+  positions(digest, mmsi, pos);
+  for (uint32_t p = 0; p < m_numPartitions; p++) {
+    if (test(p, pos))
+      return true;
+  }
+  return false;
+}
+
+bool ReplayFilter::checkAndAdd(const std::array<uint64_t, 2> &digest, uint32_t mmsi) {
+  uint64_t pos[REPLAY_MAX_HASHES];
+  positions(digest, mmsi, pos);
+
+  bool seen = false;
+  for (uint32_t p = 0; p < m_numPartitions && !seen; p++)
+    seen = test(p, pos);
+
+  //recorded again in the newest partition so a repeated frame stays in the window
+  uint64_t *words = &m_words[m_current * m_partitionWords];
+  for (int n = 0; n < m_numHashes; n++)
+    words[pos[n] >> 6] |= 1ULL << (pos[n] & 63);
+
+  return seen;
+}
+
+void ReplayFilter::advance_to(uint64_t slot) {
+  if (!m_started) {
+    m_started = true;
+    m_now = slot;
+    return;
+  }
+  if (slot <= m_now)
+    return;
+
+  //longer than the whole window: everything is forgotten
+  uint64_t elapsed = slot - m_now;
+  m_now = slot;
+  if (elapsed >= (uint64_t)m_numPartitions * m_slotsPerPartition) {
+    std::fill(m_words.begin(), m_words.end(), 0);
+    m_slot = 0;
+    return;
+  }
+
+  //retire the oldest partition, O(partitionBits / 64) once every slotsPerPartition slots
+  for (m_slot += elapsed; m_slot >= m_slotsPerPartition; m_slot -= m_slotsPerPartition) {
+    m_current = (m_current + 1) % m_numPartitions;
+    std::fill(m_words.begin() + m_current * m_partitionWords,
+              m_words.begin() + (m_current + 1) * m_partitionWords, 0);
+  }
+}
+
+uint64_t ReplayFilter::window_slots() const {
+  return (uint64_t)(m_numPartitions - 1) * m_slotsPerPartition;
+}
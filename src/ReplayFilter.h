@@ -0,0 +1,41 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <array>
+#include "BloomFilter.h"
+
+/*
+ * Age-partitioned Bloom filter for replay detection over a sliding window of slots, moved
+ * by a time based slot clock so sending more frames does not shorten the window.
+ * Frames are keyed on their CaesarHash digest and the source MMSI, and inserted
+ * in the newest of numPartitions partitions. Every slotsPerPartition slots the oldest
+ * partition is cleared and becomes the newest, so memory is fixed and a frame is
+ * remembered for at least (numPartitions - 1) * slotsPerPartition slots.
+ */
+struct ReplayFilter {
+  ReplayFilter(uint32_t numPartitions, uint32_t slotsPerPartition, uint64_t partitionBits, uint8_t numHashes);
+
+  //true if the frame was already seen in the window, the frame is then recorded
+  bool checkAndAdd(const std::array<uint64_t, 2> &digest, uint32_t mmsi);
+  bool possiblyContains(const std::array<uint64_t, 2> &digest, uint32_t mmsi) const;
+
+  //move the window to slot (of a time based slot clock), retiring the partitions it leaves behind
+  void advance_to(uint64_t slot);
+
+  uint64_t window_slots() const;
+
+private:
+  void positions(const std::array<uint64_t, 2> &digest, uint32_t mmsi, uint64_t *out) const;
+  bool test(uint32_t partition, const uint64_t *pos) const;
+
+  uint32_t m_numPartitions;
+  uint32_t m_slotsPerPartition;
+  uint64_t m_partitionBits;
+  uint64_t m_partitionWords;
+  uint8_t m_numHashes;
+  uint32_t m_current;
+  uint32_t m_slot;
+  uint64_t m_now;
+  bool m_started;
+  std::vector<uint64_t> m_words;
+};
@@ -0,0 +1,85 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <stddef.h>
+#include <thread>
+#include <unistd.h>
+
+/*
+ * Bounded lock-free ring between one producer and one consumer thread. Head and tail live
+ * on their own cache lines and each side keeps a cached copy of the other index, so an
+ * uncontended push or pop touches no shared line. push()/pop() wait when the queue is full
+ * or empty: spin, then yield, then sleep, so an idle stage does not hold a core.
+ * Depth high-water mark and producer stalls are kept for the receiver metrics.
+ */
+template <class T, std::size_t Capacity>
+struct SpscQueue {
+  static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+  SpscQueue() : m_head(0), m_tail(0), m_cachedHead(0), m_cachedTail(0), m_maxDepth(0), m_stalls(0) {}
+
+  bool try_push(const T &item) {
+    std::size_t tail = m_tail.load(std::memory_order_relaxed);
+    if (tail - m_cachedHead == Capacity) {
+      m_cachedHead = m_head.load(std::memory_order_acquire);
+      if (tail - m_cachedHead == Capacity)
+        return false;
+    }
+    m_items[tail & (Capacity - 1)] = item;
+    m_tail.store(tail + 1, std::memory_order_release);
+    if (tail + 1 - m_cachedHead > m_maxDepth.load(std::memory_order_relaxed))
+      m_maxDepth.store(tail + 1 - m_cachedHead, std::memory_order_relaxed);
+    return true;
+  }
+
+  bool try_pop(T &item) {
+    std::size_t head = m_head.load(std::memory_order_relaxed);
+    if (head == m_cachedTail) {
+      m_cachedTail = m_tail.load(std::memory_order_acquire);
+      if (head == m_cachedTail)
+        return false;
+    }
+    item = m_items[head & (Capacity - 1)];
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  void push(const T &item) {
+    if (try_push(item))
+      return;
+    m_stalls.fetch_add(1, std::memory_order_relaxed);
+    for (unsigned spins = 0; !try_push(item); spins++)
+      wait(spins);
+  }
+
+  void pop(T &item) {
+    for (unsigned spins = 0; !try_pop(item); spins++)
+      wait(spins);
+  }
+
+  //approximate when read from a third thread
+  std::size_t depth() const {
+    return m_tail.load(std::memory_order_relaxed) - m_head.load(std::memory_order_relaxed);
+  }
+  std::size_t max_depth() const { return m_maxDepth.load(std::memory_order_relaxed); }
+  uint64_t stalls() const { return m_stalls.load(std::memory_order_relaxed); }
+  static constexpr std::size_t capacity() { return Capacity; }
+
+private:
+  static void wait(unsigned spins) {
+    if (spins < 64)
+      return;
+    if (spins < 1024)
+      std::this_thread::yield();
+    else
+      usleep(100);
+  }
+
+  alignas(64) std::atomic<std::size_t> m_head;    //consumer
+  alignas(64) std::atomic<std::size_t> m_tail;    //producer
+  alignas(64) std::size_t m_cachedHead;           //producer's copy of m_head
+  alignas(64) std::size_t m_cachedTail;           //consumer's copy of m_tail
+  alignas(64) std::atomic<std::size_t> m_maxDepth;
+  std::atomic<uint64_t> m_stalls;
+  T m_items[Capacity];
+};
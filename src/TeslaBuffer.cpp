@@ -0,0 +1,169 @@
+#include "TeslaBuffer.h"
+#include <algorithm>
+
+TeslaBuffer::TeslaBuffer(uint32_t disclosureDelay, uint32_t expirySlots, uint32_t maxWaiting)
+      : m_disclosureDelay(disclosureDelay),
+        m_expirySlots(std::max(1u, expirySlots)),
+        m_maxWaiting(std::max(1u, maxWaiting)),
+        m_now(0) {}
+
+TeslaBuffer::Sender &TeslaBuffer::sender(uint32_t mmsi) {
+  auto it = m_senders.find(mmsi);
+  if (it == m_senders.end()) {
+    Sender s;
+    s.next = 0;
+    s.key = NULL;
+    s.verifying = false;
+    it = m_senders.emplace(mmsi, s).first;
+  }
+  return it->second;
+}
+
+void TeslaBuffer::purge(std::deque<TeslaInterval> &intervals, uint32_t before, std::vector<ais_message_t *> &purged) {
+  while (!intervals.empty() && intervals.front().index < before) {
+    purged.insert(purged.end(), intervals.front().messages.begin(), intervals.front().messages.end());
+    intervals.pop_front();
+  }
+}
+
+void TeslaBuffer::purge_expired(Sender &s, std::vector<ais_message_t *> &purged) {
+  //the interval of the disclosure being verified is referenced by its job until settle()
+  bool pinned = s.verifying && s.waiting.front().closed >= m_disclosureDelay;
+  uint32_t keep = pinned ? s.waiting.front().closed - m_disclosureDelay : 0;
+  while (!s.intervals.empty() && s.intervals.front().deadline <= m_now && !(pinned && s.intervals.front().index == keep))
+    purge(s.intervals, s.intervals.front().index + 1, purged);
+}
+
+void TeslaBuffer::undo_boundary(Sender &s, uint32_t closed) {
+  //interval closed and the one after it become one again, later intervals move down one index
+  for (auto it = s.intervals.begin(); it != s.intervals.end(); ++it) {
+    if (it->index != closed)
+      continue;
+    auto after = it + 1;
+    if (after != s.intervals.end() && after->index == closed + 1) {
+      after->messages.insert(after->messages.begin(), it->messages.begin(), it->messages.end());
+      after->timeslots += it->timeslots;
+      after->deadline = std::min(after->deadline, it->deadline);
+      s.intervals.erase(it);
+    }
+    break;
+  }
+  for (auto &interval : s.intervals)
+    if (interval.index > closed)
+      interval.index--;
+  for (auto &d : s.waiting)
+    if (d.closed > closed)
+      d.closed--;
+  s.next--;
+}
+
+void TeslaBuffer::add(ais_message_t *m) {
+  Sender &s = sender(m->src_mmsi);
+  if (s.intervals.empty() || s.intervals.back().index != s.next) {
+    TeslaInterval interval;
+    interval.index = s.next;
+    interval.deadline = m->slot + m_expirySlots;
+    interval.timeslots = 0;
+    s.intervals.push_back(interval);
+    Deadline d = {interval.deadline, m->src_mmsi};
+    m_deadlines.push_back(d);
+  }
+  TeslaInterval &open = s.intervals.back();
+  open.messages.push_back(m);
+  //one AIS slot has passed for the key chain of the sender
+  if (m->type == 4)
+    open.timeslots++;
+}
+
+ais_message_t *TeslaBuffer::hold_key(ais_message_t *m) {
+  Sender &s = sender(m->src_mmsi);
+  ais_message_t *previous = s.key;
+  s.key = m;
+  Deadline d = {m->slot + m_expirySlots, m->src_mmsi};
+  m_deadlines.push_back(d);
+  return previous;
+}
+
+ais_message_t *TeslaBuffer::take_key(uint32_t mmsi) {
+  auto it = m_senders.find(mmsi);
+  if (it == m_senders.end())
+    return NULL;
+  ais_message_t *key = it->second.key;
+  it->second.key = NULL;
+  return key;
+}
+
+TeslaBuffer::Intake TeslaBuffer::disclose(uint32_t mmsi, TeslaDisclosure &d) {
+  Sender &s = sender(mmsi);
+  //a flood of disclosures under one MMSI does not queue without bound
+  if (s.waiting.size() > m_maxWaiting)
+    return DROPPED;
+  d.closed = s.next++;
+  s.waiting.push_back(d);
+  if (s.verifying)
+    return WAITING;
+  s.verifying = true;
+  return VERIFY;
+}
+
+bool TeslaBuffer::disclosed(uint32_t mmsi, const TeslaDisclosure &d, TeslaInterval &out) const {
+  auto it = m_senders.find(mmsi);
+  if (it == m_senders.end() || d.closed < m_disclosureDelay)
+    return false;
+  for (const TeslaInterval &interval : it->second.intervals) {
+    if (interval.index == d.closed - m_disclosureDelay) {
+      out = interval;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool TeslaBuffer::settle(uint32_t mmsi, bool verified, std::vector<ais_message_t *> &purged, TeslaDisclosure &next) {
+  auto it = m_senders.find(mmsi);
+  if (it == m_senders.end() || !it->second.verifying)
+    return false;
+  Sender &s = it->second;
+  TeslaDisclosure d = s.waiting.front();
+  s.waiting.pop_front();
+  s.verifying = false;
+  if (verified) {
+    if (d.closed >= m_disclosureDelay) {
+      uint32_t index = d.closed - m_disclosureDelay;
+      //intervals before the disclosed one lost their key, the disclosed one was verified by the job
+      purge(s.intervals, index, purged);
+      if (!s.intervals.empty() && s.intervals.front().index == index)
+        s.intervals.pop_front();
+    }
+  } else {
+    undo_boundary(s, d.closed);
+  }
+  //deadlines passed while the interval was pinned
+  purge_expired(s, purged);
+  if (s.waiting.empty())
+    return false;
+  next = s.waiting.front();
+  s.verifying = true;
+  return true;
+}
+
+void TeslaBuffer::expire(uint32_t now, std::vector<ais_message_t *> &purged) {
+  m_now = now;
+  while (!m_deadlines.empty() && m_deadlines.front().slot <= now) {
+    Deadline d = m_deadlines.front();
+    m_deadlines.pop_front();
+    auto it = m_senders.find(d.mmsi);
+    if (it == m_senders.end())
+      continue;
+    //the entry may be stale (interval disclosed, sender forgotten and seen again): deadlines are checked again
+    Sender &s = it->second;
+    purge_expired(s, purged);
+    if (s.key && s.key->slot + m_expirySlots <= now) {
+      purged.push_back(s.key);
+      s.key = NULL;
+    }
+    //nothing buffered
+    if (s.intervals.empty() && !s.key && s.waiting.empty())
+      m_senders.erase(it);
+  }
+}
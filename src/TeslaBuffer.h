@@ -0,0 +1,86 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+#include "ais_receiver/ais_rx.h"
+
+//messages of a sender covered by the MAC tag of one key disclosure
+struct TeslaInterval {
+  uint32_t index;
+  uint32_t deadline;                        //slot after which the interval is purged unverified
+  int timeslots;                            //type 4 messages, chain walk of the disclosed key
+  std::vector<ais_message_t *> messages;    //oldest first
+};
+
+//key disclosure of a sender, verified against the interval disclosureDelay intervals before the one it closed
+struct TeslaDisclosure {
+  ais_message_t *key;                       //TESLA message
+  ais_message_t *message;                   //message completing the disclosure: the B.F. message of levels 5-7, else key
+  uint32_t slot;
+  uint32_t closed;                          //index of the interval it closed
+};
+
+/*
+ * TESLA buffer of a verifier: per sender, the intervals still waiting for their key, indexed
+ * by interval number. A message is appended to the open interval of its sender, a key
+ * disclosure closes it and opens the next one. The disclosure is only tentative, since its
+ * MMSI is not authenticated: the interval it discloses, disclosureDelay intervals back, stays
+ * buffered until settle() reports the outcome of its verification. A verified key removes the
+ * interval and purges the older ones; a key that does not verify only undoes the boundary it
+ * closed, so a forged disclosure cannot take the interval from the genuine one. Disclosures of
+ * a sender are verified one at a time, the next ones wait (up to maxWaiting) for the interval
+ * boundaries to be settled. Intervals whose key has not come expirySlots slots after their
+ * first message are purged. Records are arena records of the verifier thread, never copied.
+ */
+struct TeslaBuffer {
+  enum Intake { VERIFY, WAITING, DROPPED };
+
+  TeslaBuffer(uint32_t disclosureDelay, uint32_t expirySlots, uint32_t maxWaiting);
+
+  //message covered by the MAC tag of the open interval of its sender
+  void add(ais_message_t *m);
+
+  //TESLA message of levels 5-7, waits for the B.F. message of the sender; a key held before is returned to purge
+  ais_message_t *hold_key(ais_message_t *m);
+  ais_message_t *take_key(uint32_t mmsi);
+
+  //disclosure d of mmsi closes its open interval: VERIFY now, WAITING behind the disclosure being verified, or DROPPED
+  Intake disclose(uint32_t mmsi, TeslaDisclosure &d);
+
+  //copy of the interval disclosed by d, false if none is buffered
+  bool disclosed(uint32_t mmsi, const TeslaDisclosure &d, TeslaInterval &out) const;
+
+  //outcome of the disclosure of mmsi being verified, true and the next one to verify in next if one waits
+  bool settle(uint32_t mmsi, bool verified, std::vector<ais_message_t *> &purged, TeslaDisclosure &next);
+
+  //intervals and held keys past their deadline at slot now
+  void expire(uint32_t now, std::vector<ais_message_t *> &purged);
+
+  size_t senders() const { return m_senders.size(); }
+
+private:
+  struct Sender {
+    std::deque<TeslaInterval> intervals;    //oldest first, the last one open if its index is next
+    uint32_t next;                          //index of the open interval
+    ais_message_t *key;                     //held TESLA message
+    bool verifying;                         //front of waiting is being verified
+    std::deque<TeslaDisclosure> waiting;
+  };
+  struct Deadline {
+    uint32_t slot;
+    uint32_t mmsi;
+  };
+
+  Sender &sender(uint32_t mmsi);
+  static void purge(std::deque<TeslaInterval> &intervals, uint32_t before, std::vector<ais_message_t *> &purged);
+  void purge_expired(Sender &s, std::vector<ais_message_t *> &purged);
+  void undo_boundary(Sender &s, uint32_t closed);
+
+  uint32_t m_disclosureDelay;
+  uint32_t m_expirySlots;
+  uint32_t m_maxWaiting;
+  uint32_t m_now;                           //slot of the last expire()
+  std::unordered_map<uint32_t, Sender> m_senders;
+  std::deque<Deadline> m_deadlines;         //in slot order, deadlines only grow
+};
@@ -0,0 +1,98 @@
+#include "VerifyBudget.h"
+#include <algorithm>
+
+VerifyBudget::VerifyBudget(uint32_t maxChainWalk, uint32_t senderRate, uint32_t senderBurst, uint32_t globalRate,
+                           uint32_t globalBurst, uint32_t reservePercent, uint32_t maxSenders)
+      : m_maxChainWalk(maxChainWalk),
+        m_senderRate(senderRate),
+        m_senderBurst(senderBurst),
+        m_globalRate(globalRate),
+        m_globalBurst(globalBurst),
+        m_reserve((int64_t)globalBurst * std::min(reservePercent, 100u) / 100),
+        m_maxSenders(std::max(1u, maxSenders)),
+        m_globalTokens(globalBurst),
+        m_slot(0) {
+  for (int a = 0; a < NUM_ADMIT; a++)
+    m_count[a] = 0;
+}
+
+const char *VerifyBudget::reason(Admit a) {
+  switch (a) {
+    case ADMITTED: return "admitted";
+    case CHAIN_TOO_LONG: return "chain walk longer than the frames of the interval";
+    case SENDER_BUDGET: return "hash budget of the MMSI spent";
+    case GLOBAL_BUDGET: return "global hash budget spent";
+    default: return "";
+  }
+}
+
+void VerifyBudget::refill(uint32_t slot) {
+  //slots of the verifier threads are only roughly in order
+  if (slot <= m_slot)
+    return;
+  m_globalTokens = std::min((int64_t)m_globalBurst, m_globalTokens + (int64_t)m_globalRate * (slot - m_slot));
+  m_slot = slot;
+}
+
+VerifyBudget::Sender &VerifyBudget::sender(uint32_t mmsi, uint32_t slot) {
+  auto it = m_senders.find(mmsi);
+  if (it == m_senders.end()) {
+    //table full (e.g. disclosures forged under random MMSIs): forget the senders not trusted
+    if (m_senders.size() >= m_maxSenders) {
+      for (auto s = m_senders.begin(); s != m_senders.end(); ) {
+        if (trusted(s->second))
+          ++s;
+        else
+          s = m_senders.erase(s);
+      }
+    }
+    Sender s = {(int64_t)m_senderBurst, slot, 0};
+    it = m_senders.emplace(mmsi, s).first;
+  }
+  Sender &s = it->second;
+  if (slot > s.lastSlot) {
+    s.tokens = std::min((int64_t)m_senderBurst, s.tokens + (int64_t)m_senderRate * (slot - s.lastSlot));
+    s.lastSlot = slot;
+  }
+  return s;
+}
+
+VerifyBudget::Admit VerifyBudget::admit(uint32_t mmsi, uint32_t slot, uint32_t chainWalk, uint32_t frames,
+                                        uint32_t hashes) {
+  Admit a = ADMITTED;
+  {
+    std::lock_guard<std::mutex> lock(m_lock);
+    refill(slot);
+    Sender &s = sender(mmsi, slot);
+    //one key per type 4 frame of the interval: a longer walk cannot come from the sender's chain
+    if (chainWalk > frames || chainWalk > m_maxChainWalk)
+      a = CHAIN_TOO_LONG;
+    else if (s.tokens < (int64_t)hashes)
+      a = SENDER_BUDGET;
+    else if (m_globalTokens - (trusted(s) ? 0 : m_reserve) < (int64_t)hashes)
+      a = GLOBAL_BUDGET;
+    else {
+      s.tokens -= hashes;
+      m_globalTokens -= hashes;
+    }
+  }
+  m_count[a].fetch_add(1, std::memory_order_relaxed);
+  return a;
+}
+
+void VerifyBudget::report(uint32_t mmsi, uint32_t slot, bool verified, uint32_t hashes) {
+  std::lock_guard<std::mutex> lock(m_lock);
+  if (verified) {
+    sender(mmsi, slot).verified++;
+    return;
+  }
+  //anyone can fail under any MMSI: the failure is paid from the share of the senders not trusted
+  refill(slot);
+  m_globalTokens = std::max(std::min(m_globalTokens, m_reserve), m_globalTokens - (int64_t)hashes);
+}
+
+bool VerifyBudget::trusted(uint32_t mmsi) {
+  std::lock_guard<std::mutex> lock(m_lock);
+  auto it = m_senders.find(mmsi);
+  return it != m_senders.end() && trusted(it->second);
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+/*
+ * Hash budget of the CAESAR verification, so forged disclosures cannot keep the verifiers
+ * busy. Every disclosure is charged its chain walk and HMAC hashes to a token bucket of its
+ * MMSI and to a global bucket, both refilled per AIS slot of the receiver's slot clock
+ * (26.67 ms of wall-clock time, not per frame, so sending more frames buys no budget).
+ * A chain walk longer than the frames buffered for the disclosed interval (or than
+ * maxChainWalk) is refused without hashing. The bound counts frames, not time, so a burst
+ * of frames (a replayed NMEA log, reads coalesced by a stream) verifies as on air. The MMSI of a disclosure that fails is not
+ * authenticated, so a failure is not held against it: its hashes are charged a second time
+ * to the global bucket outside the reserve. The last reservePercent of the global bucket is
+ * only spent on senders whose key has verified, so they keep being verified during a flood.
+ * Shared by the verifier threads, calls are made once per disclosure.
+ */
+struct VerifyBudget {
+  enum Admit { ADMITTED, CHAIN_TOO_LONG, SENDER_BUDGET, GLOBAL_BUDGET, NUM_ADMIT };
+
+  VerifyBudget(uint32_t maxChainWalk, uint32_t senderRate, uint32_t senderBurst, uint32_t globalRate,
+               uint32_t globalBurst, uint32_t reservePercent, uint32_t maxSenders);
+
+  //charges hashes (chainWalk of them walking the key chain) of a disclosure of mmsi at slot, covering frames
+  Admit admit(uint32_t mmsi, uint32_t slot, uint32_t chainWalk, uint32_t frames, uint32_t hashes);
+  //outcome of an admitted verification of hashes
+  void report(uint32_t mmsi, uint32_t slot, bool verified, uint32_t hashes);
+
+  bool trusted(uint32_t mmsi);
+  uint64_t count(Admit a) const { return m_count[a].load(std::memory_order_relaxed); }
+  static const char *reason(Admit a);
+
+private:
+  struct Sender {
+    int64_t tokens;
+    uint32_t lastSlot;        //of the last refill
+    uint32_t verified;
+  };
+
+  Sender &sender(uint32_t mmsi, uint32_t slot);
+  void refill(uint32_t slot);
+  static bool trusted(const Sender &s) { return s.verified > 0; }
+
+  uint32_t m_maxChainWalk;
+  uint32_t m_senderRate;
+  uint32_t m_senderBurst;
+  uint32_t m_globalRate;
+  uint32_t m_globalBurst;
+  int64_t m_reserve;
+  uint32_t m_maxSenders;
+  int64_t m_globalTokens;
+  uint32_t m_slot;
+  std::atomic<uint64_t> m_count[NUM_ADMIT];
+  std::unordered_map<uint32_t, Sender> m_senders;
+  std::mutex m_lock;
+};
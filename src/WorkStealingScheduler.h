@@ -0,0 +1,88 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stddef.h>
+#include <vector>
+
+/*
+ * Per-worker task deques with stealing. A worker takes its own newest task first, an idle
+ * worker steals the oldest task of another one, so a burst landing on one worker spreads
+ * over the others. A task that only did part of its work (a chunk of a long chain walk) is
+ * put back at the oldest end: the owner runs the newer short tasks before resuming it, and
+ * it is the first task a thief picks up.
+ * Each deque has its own lock, held only to move one pointer in or out.
+ */
+template <class T>
+class WorkStealingScheduler {
+public:
+  explicit WorkStealingScheduler(int workers) : m_workers(workers), m_pending(0) {
+    for (int i = 0; i < workers; i++)
+      m_workers[i].reset(new Worker());
+  }
+
+  //new task of worker
+  void push(int worker, T task) {
+    Worker &w = *m_workers[worker];
+    std::lock_guard<std::mutex> lock(w.m_lock);
+    w.m_tasks.push_back(task);
+    m_pending.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  //task resumed later, behind the tasks already queued by worker
+  void push_resumed(int worker, T task) {
+    Worker &w = *m_workers[worker];
+    std::lock_guard<std::mutex> lock(w.m_lock);
+    w.m_tasks.push_front(task);
+    m_pending.fetch_add(1, std::memory_order_relaxed);
+    w.m_resumed.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  //newest task of worker, else the oldest task of the first other worker that has one
+  bool pop(int worker, T &task) {
+    if (m_pending.load(std::memory_order_relaxed) == 0)
+      return false;
+    Worker &own = *m_workers[worker];
+    {
+      std::lock_guard<std::mutex> lock(own.m_lock);
+      if (!own.m_tasks.empty()) {
+        task = own.m_tasks.back();
+        own.m_tasks.pop_back();
+        m_pending.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+      }
+    }
+    for (size_t k = 1; k < m_workers.size(); k++) {
+      Worker &victim = *m_workers[(worker + k) % m_workers.size()];
+      std::lock_guard<std::mutex> lock(victim.m_lock);
+      if (!victim.m_tasks.empty()) {
+        task = victim.m_tasks.front();
+        victim.m_tasks.pop_front();
+        m_pending.fetch_sub(1, std::memory_order_relaxed);
+        own.m_steals.fetch_add(1, std::memory_order_relaxed);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  //approximate when read while workers run
+  size_t pending() const { return m_pending.load(std::memory_order_relaxed); }
+  uint64_t steals(int worker) const { return m_workers[worker]->m_steals.load(std::memory_order_relaxed); }
+  uint64_t resumed(int worker) const { return m_workers[worker]->m_resumed.load(std::memory_order_relaxed); }
+  int workers() const { return (int)m_workers.size(); }
+
+private:
+  struct Worker {
+    Worker() : m_steals(0), m_resumed(0) {}
+    alignas(64) std::mutex m_lock;
+    std::deque<T> m_tasks;
+    std::atomic<uint64_t> m_steals;     //tasks taken from other workers
+    std::atomic<uint64_t> m_resumed;    //partial tasks put back
+  };
+
+  std::vector<std::unique_ptr<Worker>> m_workers;
+  alignas(64) std::atomic<size_t> m_pending;
+};
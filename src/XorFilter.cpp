@@ -0,0 +1,178 @@
+#include "XorFilter.h"
+#include <algorithm>
+
+#define XOR_FILTER_MAX_ITERATIONS 100
+
+static inline uint64_t keyHash(const uint8_t *data, std::size_t len) {
+  return CaesarHash::hash(data, len)[0];
+}
+
+static inline uint64_t mix(uint64_t key, uint32_t seed) {
+  //fmix64 finalizer of MurmurHash3
+  uint64_t h = key + seed;
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+static inline uint32_t reduce(uint32_t hash, uint32_t n) {
+  return (uint32_t)(((uint64_t)hash * n) >> 32);
+}
+
+static inline uint64_t rotl64(uint64_t n, unsigned int c) {
+  return (n << (c & 63)) | (n >> ((-c) & 63));
+}
+
+static inline uint16_t fingerprint(uint64_t hash) {
+  return (uint16_t)(hash ^ (hash >> 32));
+}
+
+static inline uint32_t slot(uint64_t hash, int index, uint32_t blockLength) {
+  return reduce((uint32_t)rotl64(hash, index * 21), blockLength) + index * blockLength;
+}
+
+XorFilter::XorFilter(uint64_t numKeys)
+      : m_seed(0),
+        m_built(false) {
+  uint32_t capacity = XOR_FILTER_SLACK + 1.23 * numKeys;
+  m_blockLength = capacity / 3;
+  m_fingerprints.assign(3 * m_blockLength, 0);
+}
+
+void XorFilter::add(const uint8_t *data, std::size_t len) {
+  m_keys.push_back(keyHash(data, len));
+  m_built = false;
+}
+
+void XorFilter::addHashed(const std::array<uint64_t, 2> &hashValues) {
+  m_keys.push_back(hashValues[0]);
+  m_built = false;
+}
+
+bool XorFilter::build() {
+  //identical messages in the same epoch would never peel
+  std::sort(m_keys.begin(), m_keys.end());
+  m_keys.erase(std::unique(m_keys.begin(), m_keys.end()), m_keys.end());
+
+  std::size_t capacity = m_fingerprints.size();
+  std::vector<uint64_t> xormask(capacity);
+  std::vector<uint8_t> count(capacity);
+  std::vector<uint32_t> queue(capacity);
+  std::vector<std::pair<uint32_t, uint64_t>> stack;
+  stack.reserve(m_keys.size());
+
+  for (m_seed = 0; m_seed < XOR_FILTER_MAX_ITERATIONS; m_seed++) {
+    std::fill(xormask.begin(), xormask.end(), 0);
+    std::fill(count.begin(), count.end(), 0);
+    stack.clear();
+
+    for (uint64_t key : m_keys) {
+      uint64_t hash = mix(key, m_seed);
+      for (int i = 0; i < 3; i++) {
+        uint32_t h = slot(hash, i, m_blockLength);
+        xormask[h] ^= hash;
+        count[h]++;
+      }
+    }
+
+    //peel slots that are hit by a single key
+    std::size_t qsize = 0;
+    for (uint32_t i = 0; i < capacity; i++) {
+      if (count[i] == 1)
+        queue[qsize++] = i;
+    }
+    while (qsize > 0) {
+      uint32_t index = queue[--qsize];
+      if (count[index] == 0)
+        continue;
+      uint64_t hash = xormask[index];
+      stack.push_back(std::make_pair(index, hash));
+      for (int i = 0; i < 3; i++) {
+        uint32_t h = slot(hash, i, m_blockLength);
+        xormask[h] ^= hash;
+        if (--count[h] == 1)
+          queue[qsize++] = h;
+      }
+    }
+
+    if (stack.size() == m_keys.size())
+      break;
+  }
+
+  if (m_seed == XOR_FILTER_MAX_ITERATIONS) {
+    printf("Error: could not build xor filter for %zu keys\n", m_keys.size());
+    return false;
+  }
+
+  std::fill(m_fingerprints.begin(), m_fingerprints.end(), 0);
+  for (auto it = stack.rbegin(); it != stack.rend(); ++it) {
+    uint64_t hash = it->second;
+    uint16_t f = fingerprint(hash);
+    for (int i = 0; i < 3; i++) {
+      uint32_t h = slot(hash, i, m_blockLength);
+      if (h != it->first)
+        f ^= m_fingerprints[h];
+    }
+    m_fingerprints[it->first] = f;
+  }
+
+  m_built = true;
+  return true;
+}
+
+bool XorFilter::possiblyContains(const uint8_t *data, std::size_t len) const {
+  std::array<uint64_t, 2> hashValues = {{keyHash(data, len), 0}};
+  return containsHashed(hashValues);
+}
+
+bool XorFilter::containsHashed(const std::array<uint64_t, 2> &hashValues) const {
+  uint64_t hash = mix(hashValues[0], m_seed);
+  uint16_t f = fingerprint(hash);
+
+  return f == (m_fingerprints[slot(hash, 0, m_blockLength)] ^
+               m_fingerprints[slot(hash, 1, m_blockLength)] ^
+               m_fingerprints[slot(hash, 2, m_blockLength)]);
+}
+
+std::size_t XorFilter::size_bits() const {
+  return 32 + m_fingerprints.size() * XOR_FILTER_FINGERPRINT_BITS;
+}
+
+std::string XorFilter::get_string() {
+  if (!m_built)
+    build();
+
+  std::string ret;
+  ret.reserve(size_bits());
+  for (int i = 31; i >= 0; i--)
+    ret += ((m_seed >> i) & 1) ? '1' : '0';
+  for (uint16_t f : m_fingerprints) {
+    for (int i = XOR_FILTER_FINGERPRINT_BITS - 1; i >= 0; i--)
+      ret += ((f >> i) & 1) ? '1' : '0';
+  }
+  return ret;
+}
+
+void XorFilter::to_bits(std::string input) {
+
+  //trailing padding bits of the AIS frame are ignored
+  if (input.length() < size_bits()) {
+    printf("Error: input length smaller than xor filter size\n");
+    return;
+  }
+
+  m_seed = 0;
+  for (int i = 0; i < 32; i++)
+    m_seed = (m_seed << 1) | (input[i] == '1');
+  for (std::size_t j = 0; j < m_fingerprints.size(); j++) {
+    uint16_t f = 0;
+    for (int i = 0; i < XOR_FILTER_FINGERPRINT_BITS; i++)
+      f = (f << 1) | (input[32 + j * XOR_FILTER_FINGERPRINT_BITS + i] == '1');
+    m_fingerprints[j] = f;
+  }
+  m_built = true;
+  return;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <array>
+#include <string>
+#include <stdlib.h>
+#include <iostream>
+#include "BloomFilter.h"
+
+#define XOR_FILTER_FINGERPRINT_BITS 16
+//extra slots for small epochs, 8 builds any 9 messages within a few seeds
+#define XOR_FILTER_SLACK 8
+
+/*
+ * Static xor filter (Graf & Lemire), 16-bit fingerprints: FP rate 2^-16 = 1.5e-5 whatever the
+ * number of messages. There is no common base class with BloomFilter: it provides the same
+ * add/possiblyContains/containsHashed/get_string/to_bits members, which is all the CaesarLevel
+ * templates use. The filter is only built once all messages of the epoch have been added.
+ * Capacity (1.23 * numKeys + XOR_FILTER_SLACK slots) is derived from the expected number of
+ * messages so both ends agree on the layout.
+ * Serialized form: 32-bit construction seed followed by the fingerprint table.
+ */
+struct XorFilter {
+  XorFilter(uint64_t numKeys);
+
+  void add(const uint8_t *data, std::size_t len);
+  bool build();
+  bool possiblyContains(const uint8_t *data, std::size_t len) const;
+
+  //take a precomputed CaesarHash digest of the message, as for BloomFilter
+  void addHashed(const std::array<uint64_t, 2> &hashValues);
+  bool containsHashed(const std::array<uint64_t, 2> &hashValues) const;
+
+  std::string get_string();
+  void to_bits(std::string input);
+
+  std::size_t size_bits() const;
+
+private:
+  uint32_t m_seed;
+  uint32_t m_blockLength;
+  bool m_built;
+  std::vector<uint16_t> m_fingerprints;
+  std::vector<uint64_t> m_keys;
+};
@@ -0,0 +1,39 @@
+#include "ais_arena.h"
+
+AisArena::AisArena() : m_used(0)
+{
+}
+
+ais_message_t *AisArena::acquire()
+{
+    if (!m_free.empty())
+        return m_free.back();
+    if (m_used == m_blocks.size() * AIS_ARENA_BLOCK)
+        m_blocks.emplace_back(new ais_message_t[AIS_ARENA_BLOCK]);
+    return &record(m_used);
+}
+
+void AisArena::commit()
+{
+    if (!m_free.empty())
+        m_free.pop_back();
+    else
+        m_used++;
+}
+
+void AisArena::release(ais_message_t *m)
+{
+    m_free.push_back(m);
+}
+
+void AisArena::reset()
+{
+    m_used = 0;
+    m_free.clear();
+}
+
+AisArena &ais_thread_arena()
+{
+    static thread_local AisArena arena;
+    return arena;
+}
@@ -0,0 +1,52 @@
+/*
+ *    ais_arena.h
+ *
+ *    Per-thread arena of decoded ais_message_t records. Records are handed out from blocks
+ *    of AIS_ARENA_BLOCK records, so receiving a frame costs no heap allocation once a block
+ *    is in place, and record addresses stay valid until reset(). Records no longer referenced
+ *    are released to a free list and handed out again before the blocks grow, so the arena
+ *    stays as large as the records in use at once.
+ */
+
+#ifndef INC_AIS_ARENA_H
+#define INC_AIS_ARENA_H
+
+#include <stddef.h>
+#include <memory>
+#include <vector>
+#include <type_traits>
+
+#include "ais_rx.h"
+
+#define     AIS_ARENA_BLOCK          1024
+
+static_assert(std::is_trivially_copyable<ais_message_t>::value, "ais_message_t must stay plain data");
+
+struct AisArena {
+    AisArena();
+
+    /* record for the next frame, the same one until commit() is called, only counted in size() then */
+    ais_message_t *acquire();
+    void commit();
+
+    /* committed record no longer referenced, handed out again by acquire() */
+    void release(ais_message_t *m);
+
+    /* drop every record, the blocks are kept for reuse */
+    void reset();
+
+    size_t size() const { return m_used - m_free.size(); }
+    size_t capacity() const { return m_blocks.size() * AIS_ARENA_BLOCK; }
+
+private:
+    ais_message_t &record(size_t i) { return m_blocks[i / AIS_ARENA_BLOCK][i % AIS_ARENA_BLOCK]; }
+
+    std::vector<std::unique_ptr<ais_message_t[]>> m_blocks;
+    std::vector<ais_message_t *> m_free;     /* released records, last released first */
+    size_t m_used;                           /* records handed out from the blocks */
+};
+
+/* arena of the calling thread */
+AisArena &ais_thread_arena();
+
+#endif
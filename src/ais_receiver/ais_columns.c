@@ -0,0 +1,192 @@
+#include "ais_columns.h"
+
+void AisColumns::clear()
+{
+    AisPositionColumns &p = position;
+    p.index.clear(); p.mmsi.clear(); p.type.clear(); p.lat.clear(); p.lon.clear();
+    p.sog.clear(); p.cog.clear(); p.heading.clear(); p.second.clear();
+
+    AisBaseStationColumns &b = base_station;
+    b.index.clear(); b.mmsi.clear(); b.lat.clear(); b.lon.clear(); b.timestamp.clear();
+
+    AisStaticColumns &s = static_data;
+    s.index.clear(); s.mmsi.clear(); s.type.clear(); s.shiptype.clear(); s.length.clear();
+    s.width.clear(); s.draught.clear(); s.name.clear(); s.callsign.clear();
+
+    AisBinaryColumns &d = binary;
+    d.index.clear(); d.mmsi.clear(); d.dst_mmsi.clear(); d.type.clear(); d.security_level.clear();
+    d.appmeta_bits.clear(); d.payload_offset.clear(); d.payload_bits.clear();
+
+    records = 0;
+    other = 0;
+}
+
+size_t AisColumns::size() const
+{
+    return records;
+}
+
+/*
+ *  Days since 1970-01-01 of a proleptic Gregorian date (H. Hinnant's days_from_civil)
+ */
+static int64_t days_from_civil(int64_t y, unsigned m, unsigned d)
+{
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = (unsigned)(y - era * 400);
+    const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + (int64_t)doe - 719468;
+}
+
+/*
+ *  Position columns of records of one layout (AisType1 or AisType18)
+ */
+template <class Layout>
+static void decode_positions(const ais_message_t *msgs, const std::vector<uint32_t> &group, AisPositionColumns &c)
+{
+    for (uint32_t i : group) {
+        const uint8_t *f = msgs[i].frame;
+        c.index.push_back(i);
+        c.mmsi.push_back(Layout::mmsi::get(f));
+        c.type.push_back(msgs[i].type);
+        c.lat.push_back(Layout::lat::value(f));
+        c.lon.push_back(Layout::lon::value(f));
+        c.sog.push_back(Layout::sog::value(f));
+        c.cog.push_back(Layout::course::value(f));
+        c.heading.push_back(Layout::heading::get(f));
+        c.second.push_back(Layout::second::get(f));
+    }
+}
+
+static void decode_base_stations(const ais_message_t *msgs, const std::vector<uint32_t> &group, AisBaseStationColumns &c)
+{
+    for (uint32_t i : group) {
+        const uint8_t *f = msgs[i].frame;
+        long year = AisType4::year::get(f), month = AisType4::month::get(f), day = AisType4::day::get(f);
+        long hour = AisType4::hour::get(f), minute = AisType4::minute::get(f), second = AisType4::second::get(f);
+        int64_t timestamp = -1;
+
+        if (year > 0 && month >= 1 && month <= 12 && day >= 1 && day <= 31 && hour < 24 && minute < 60 && second < 60)
+            timestamp = days_from_civil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second;
+
+        c.index.push_back(i);
+        c.mmsi.push_back(AisType4::mmsi::get(f));
+        c.lat.push_back(AisType4::lat::value(f));
+        c.lon.push_back(AisType4::lon::value(f));
+        c.timestamp.push_back(timestamp);
+    }
+}
+
+static void decode_static(const ais_message_t *msgs, const std::vector<uint32_t> &group, AisStaticColumns &c)
+{
+    for (uint32_t i : group) {
+        const uint8_t *f = msgs[i].frame;
+        std::array<char, 21> name = {};
+        std::array<char, 8> callsign = {};
+        long shiptype = 0, length = 0, width = 0;
+        float draught = 0;
+
+        switch (msgs[i].type) {
+        case 5:
+            AisType5::shipname::get(f, name.data());
+            AisType5::callsign::get(f, callsign.data());
+            shiptype = AisType5::shiptype::get(f);
+            length = AisType5::to_bow::get(f) + AisType5::to_stern::get(f);
+            width = AisType5::to_port::get(f) + AisType5::to_starboard::get(f);
+            draught = AisType5::draught::value(f);
+            break;
+        case 19:
+            AisType19::shipname::get(f, name.data());
+            shiptype = AisType19::shiptype::get(f);
+            length = AisType19::to_bow::get(f) + AisType19::to_stern::get(f);
+            width = AisType19::to_port::get(f) + AisType19::to_starboard::get(f);
+            break;
+        default: /* 24 */
+            if (AisType24::partno::get(f) == 0) {
+                AisType24::shipname::get(f, name.data());
+            } else {
+                AisType24::callsign::get(f, callsign.data());
+                shiptype = AisType24::shiptype::get(f);
+                length = AisType24::to_bow::get(f) + AisType24::to_stern::get(f);
+                width = AisType24::to_port::get(f) + AisType24::to_starboard::get(f);
+            }
+            break;
+        }
+
+        c.index.push_back(i);
+        c.mmsi.push_back(AisHeader::mmsi::get(f));
+        c.type.push_back(msgs[i].type);
+        c.shiptype.push_back(shiptype);
+        c.length.push_back(length);
+        c.width.push_back(width);
+        c.draught.push_back(draught);
+        c.name.push_back(name);
+        c.callsign.push_back(callsign);
+    }
+}
+
+static void decode_binary(const ais_message_t *msgs, const std::vector<uint32_t> &group, AisBinaryColumns &c)
+{
+    /* header fields were decoded with the record */
+    for (uint32_t i : group) {
+        const ais_message_t &m = msgs[i];
+        c.index.push_back(i);
+        c.mmsi.push_back(m.src_mmsi);
+        c.dst_mmsi.push_back(m.dst_mmsi);
+        c.type.push_back(m.type);
+        c.security_level.push_back(m.security_level);
+        c.appmeta_bits.push_back(m.appmeta_bits);
+        c.payload_offset.push_back(m.payload_offset);
+        c.payload_bits.push_back(m.payload_bits);
+    }
+}
+
+void ais_decode_columns(const ais_message_t *msgs, int n, AisColumns *cols)
+{
+    enum { CLASS_A, CLASS_B, BASE_STATION, STATIC_DATA, BINARY, GROUPS };
+    static thread_local std::vector<uint32_t> groups[GROUPS];
+    int g, i;
+
+    for (g = 0; g < GROUPS; g++)
+        groups[g].clear();
+
+    for (i = 0; i < n; i++) {
+        switch (msgs[i].type) {
+        case 1:
+        case 2:
+        case 3:
+            groups[CLASS_A].push_back(i);
+            break;
+        case 19: /* position and static data in one report */
+            groups[STATIC_DATA].push_back(i);
+            /* fall through */
+        case 18:
+            groups[CLASS_B].push_back(i);
+            break;
+        case 4:
+            groups[BASE_STATION].push_back(i);
+            break;
+        case 5:
+        case 24:
+            groups[STATIC_DATA].push_back(i);
+            break;
+        case 6:
+        case 8:
+        case 25:
+        case 26:
+            groups[BINARY].push_back(i);
+            break;
+        default:
+            cols->other++;
+            break;
+        }
+    }
+    cols->records += n;
+
+    decode_positions<AisType1>(msgs, groups[CLASS_A], cols->position);
+    decode_positions<AisType18>(msgs, groups[CLASS_B], cols->position);
+    decode_base_stations(msgs, groups[BASE_STATION], cols->base_station);
+    decode_static(msgs, groups[STATIC_DATA], cols->static_data);
+    decode_binary(msgs, groups[BINARY], cols->binary);
+}
@@ -0,0 +1,88 @@
+/*
+ *    ais_columns.h
+ *
+ *    Batch decoding of ais_message_t records into structure-of-arrays columns, one set of
+ *    columns per report family, for analytics and track stores working on whole batches of
+ *    traffic instead of one printf per frame.
+ *
+ *    Library-only API: the receiver does not call it. Columns carry no authentication status,
+ *    verdicts are published by the receiver through ais_verdicts.h.
+ */
+
+#ifndef INC_AIS_COLUMNS_H
+#define INC_AIS_COLUMNS_H
+
+#include <stdint.h>
+#include <vector>
+#include <array>
+
+#include "ais_rx.h"
+
+/* position reports, types 1, 2, 3 (class A), 18 and 19 (class B) */
+struct AisPositionColumns {
+    std::vector<uint32_t> index;        /* record index in the batch */
+    std::vector<uint32_t> mmsi;
+    std::vector<uint8_t>  type;
+    std::vector<float>    lat;          /* degrees, 91 = not available */
+    std::vector<float>    lon;          /* degrees, 181 = not available */
+    std::vector<float>    sog;          /* knots, 102.3 = not available */
+    std::vector<float>    cog;          /* degrees, 360 = not available */
+    std::vector<uint16_t> heading;      /* degrees, 511 = not available */
+    std::vector<uint8_t>  second;       /* UTC second of the report, 60 = not available */
+};
+
+/* base station reports, type 4 */
+struct AisBaseStationColumns {
+    std::vector<uint32_t> index;
+    std::vector<uint32_t> mmsi;
+    std::vector<float>    lat;
+    std::vector<float>    lon;
+    std::vector<int64_t>  timestamp;    /* UTC seconds since the epoch, -1 if the date/time is not available */
+};
+
+/* static and voyage data, types 5, 19 and 24 (fields a part does not carry are 0 / empty) */
+struct AisStaticColumns {
+    std::vector<uint32_t> index;
+    std::vector<uint32_t> mmsi;
+    std::vector<uint8_t>  type;
+    std::vector<uint8_t>  shiptype;
+    std::vector<uint16_t> length;       /* metres, bow + stern */
+    std::vector<uint8_t>  width;        /* metres, port + starboard */
+    std::vector<float>    draught;      /* metres, type 5 only */
+    std::vector<std::array<char, 21>> name;
+    std::vector<std::array<char, 8>>  callsign;
+};
+
+/* binary messages, types 6, 8, 25 and 26, payload span into the record frame */
+struct AisBinaryColumns {
+    std::vector<uint32_t> index;
+    std::vector<uint32_t> mmsi;
+    std::vector<uint32_t> dst_mmsi;     /* addressed 6, 25 and 26 only */
+    std::vector<uint8_t>  type;
+    std::vector<uint8_t>  security_level;
+    std::vector<uint8_t>  appmeta_bits;
+    std::vector<uint16_t> payload_offset;
+    std::vector<uint16_t> payload_bits;
+};
+
+struct AisColumns {
+    AisPositionColumns    position;
+    AisBaseStationColumns base_station;
+    AisStaticColumns      static_data;
+    AisBinaryColumns      binary;
+    uint32_t              records = 0;  /* records decoded, a type 19 has rows in position and static_data */
+    uint32_t              other = 0;    /* records of a type without columns */
+
+    /* empty every column, capacity is kept so steady batches do not allocate */
+    void clear();
+    /* number of records decoded, not of column rows */
+    size_t size() const;
+};
+
+/*
+ *  Decode n records into cols (appended). Records are first grouped by report family, then
+ *  every family is decoded in its own loop with compile-time field offsets.
+ */
+void ais_decode_columns(const ais_message_t *msgs, int n, AisColumns *cols);
+
+#endif
@@ -0,0 +1,245 @@
+/*
+ *    ais_fields.h
+ *
+ *    Compile-time field tables of the AIS message types (ITU-R M.1371), shared by the
+ *    CAESAR transmitter (encoder, '0'/'1' frame strings) and the decoder (packed frames).
+ *    Every field is a type carrying its (offset, width, signedness, scale), so accessors
+ *    are resolved at compile time into a single load, shift and mask.
+ */
+
+#ifndef INC_AIS_FIELDS_H
+#define INC_AIS_FIELDS_H
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+
+/*
+ * Integer field of Width bits at bit Offset, MSB first. Signed fields are two's complement,
+ * Scale is the divisor from the raw value to the physical value (e.g. 600000 for 1/10000 min).
+ */
+template <int Offset, int Width, bool Signed = false, long Scale = 1>
+struct AisField {
+    static constexpr int offset = Offset;
+    static constexpr int width = Width;
+    static constexpr bool is_signed = Signed;
+    static constexpr long scale = Scale;
+    static_assert(Width >= 1 && Width <= 57, "AIS field must fit a single 64-bit load");
+
+    /* raw value from a packed frame, zero padded by 8 bytes after its end */
+    static inline long get(const uint8_t *frame) {
+        uint64_t word;
+        memcpy(&word, frame + (Offset >> 3), sizeof(word));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        word = __builtin_bswap64(word);
+#endif
+        word <<= (Offset & 7);
+        if (Signed)
+            return (long)((int64_t)word >> (64 - Width));
+        return (long)(word >> (64 - Width));
+    }
+
+    static inline double value(const uint8_t *frame) {
+        return (double)get(frame) / Scale;
+    }
+
+    /* write the low Width bits of raw into a '0'/'1' frame string */
+    static inline void put(std::string &bits, long raw) {
+        for (int i = 0; i < Width; i++)
+            bits[Offset + i] = ((raw >> (Width - 1 - i)) & 1) ? '1' : '0';
+    }
+
+    static inline void put_value(std::string &bits, double v) {
+        put(bits, lround(v * Scale));
+    }
+};
+
+/*
+ * Six-bit ASCII text field of Chars characters at bit Offset.
+ */
+template <int Offset, int Chars>
+struct AisText {
+    static constexpr int offset = Offset;
+    static constexpr int chars = Chars;
+    static constexpr int width = 6 * Chars;
+
+    /* decode into out[Chars + 1], '@' and trailing spaces removed */
+    static inline void get(const uint8_t *frame, char *out) {
+        for (int k = 0; k < Chars; k++) {
+            int pos = Offset + 6 * k;
+            uint64_t word;
+            memcpy(&word, frame + (pos >> 3), sizeof(word));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            word = __builtin_bswap64(word);
+#endif
+            int sixbit = (int)((word << (pos & 7)) >> 58);
+            if (sixbit >= 1 && sixbit <= 31)
+                out[k] = sixbit + 64;
+            else if (sixbit >= 32 && sixbit <= 63)
+                out[k] = sixbit;
+            else
+                out[k] = ' ';
+        }
+        out[Chars] = 0;
+        for (int k = Chars - 1; k >= 0 && (out[k] == ' ' || out[k] == 0); k--)
+            out[k] = 0;
+    }
+};
+
+/* common to every message type */
+struct AisHeader {
+    typedef AisField<0, 6>   type;
+    typedef AisField<6, 2>   repeat;
+    typedef AisField<8, 30>  mmsi;
+};
+
+/* 1, 2, 3: Class A position report */
+struct AisType1 : AisHeader {
+    typedef AisField<38, 4>                 navstat;
+    typedef AisField<42, 8, true>           rateofturn;
+    typedef AisField<50, 10, false, 10>     sog;
+    typedef AisField<60, 1>                 accuracy;
+    typedef AisField<61, 28, true, 600000>  lon;
+    typedef AisField<89, 27, true, 600000>  lat;
+    typedef AisField<116, 12, false, 10>    course;
+    typedef AisField<128, 9>                heading;
+    typedef AisField<137, 6>                second;
+    static constexpr int bits = 168;
+};
+
+/* 4: Base station report */
+struct AisType4 : AisHeader {
+    typedef AisField<38, 14>                year;
+    typedef AisField<52, 4>                 month;
+    typedef AisField<56, 5>                 day;
+    typedef AisField<61, 5>                 hour;
+    typedef AisField<66, 6>                 minute;
+    typedef AisField<72, 6>                 second;
+    typedef AisField<78, 1>                 accuracy;
+    typedef AisField<79, 28, true, 600000>  lon;
+    typedef AisField<107, 27, true, 600000> lat;
+    typedef AisField<134, 4>                epfd;
+    typedef AisField<138, 10>               spare;
+    typedef AisField<148, 1>                raim;
+    typedef AisField<149, 19>               radio;
+    static constexpr int bits = 168;
+};
+
+/* 5: Static and voyage related data */
+struct AisType5 : AisHeader {
+    typedef AisField<38, 2>                 ais_version;
+    typedef AisField<40, 30>                imo;
+    typedef AisText<70, 7>                  callsign;
+    typedef AisText<112, 20>                shipname;
+    typedef AisField<232, 8>                shiptype;
+    typedef AisField<240, 9>                to_bow;
+    typedef AisField<249, 9>                to_stern;
+    typedef AisField<258, 6>                to_port;
+    typedef AisField<264, 6>                to_starboard;
+    typedef AisField<294, 8, false, 10>     draught;
+    typedef AisText<302, 20>                destination;
+    static constexpr int bits = 424;
+};
+
+/* 6: Addressed binary message */
+struct AisType6 : AisHeader {
+    typedef AisField<38, 2>                 sequence;
+    typedef AisField<40, 30>                dst_mmsi;
+    typedef AisField<70, 1>                 retransmitted;
+    typedef AisField<72, 10>                dac;
+    typedef AisField<82, 6>                 fi;
+    static constexpr int data = 88;
+};
+
+/* 7, 13: Binary / safety related acknowledge, up to 4 blocks of ack_stride bits */
+struct AisType7 : AisHeader {
+    typedef AisField<40, 30>                ack_mmsi;
+    typedef AisField<70, 2>                 ack_sequence;
+    static constexpr int ack_stride = 32;
+};
+
+/* 8: Binary broadcast, CAESAR header in the first data byte */
+struct AisType8 : AisHeader {
+    typedef AisField<38, 2>                 spare;
+    typedef AisField<40, 10>                dac;
+    typedef AisField<50, 6>                 fi;
+    typedef AisField<56, 3>                 security_level;
+    typedef AisField<59, 5>                 app_meta;
+    typedef AisField<59, 3>                 fragments;      /* app meta bits 4..2 */
+    static constexpr int data = 56;
+    static constexpr int caesar_payload = 64;
+};
+
+/* 18: Class B position report */
+struct AisType18 : AisHeader {
+    typedef AisField<46, 10, false, 10>     sog;
+    typedef AisField<56, 1>                 accuracy;
+    typedef AisField<57, 28, true, 600000>  lon;
+    typedef AisField<85, 27, true, 600000>  lat;
+    typedef AisField<112, 12, false, 10>    course;
+    typedef AisField<124, 9>                heading;
+    typedef AisField<133, 6>                second;
+    static constexpr int bits = 168;
+};
+
+/* 19: Extended Class B position report */
+struct AisType19 : AisType18 {
+    typedef AisText<143, 20>                shipname;
+    typedef AisField<263, 8>                shiptype;
+    typedef AisField<271, 9>                to_bow;
+    typedef AisField<280, 9>                to_stern;
+    typedef AisField<289, 6>                to_port;
+    typedef AisField<295, 6>                to_starboard;
+    static constexpr int bits = 312;
+};
+
+/* 20: Data link management, up to 4 blocks of reserve_stride bits */
+struct AisType20 : AisHeader {
+    typedef AisField<40, 12>                offset;
+    typedef AisField<52, 4>                 slots;
+    typedef AisField<56, 3>                 timeout;
+    typedef AisField<59, 11>                increment;
+    static constexpr int reserve_stride = 30;
+};
+
+/* 24: Static data report, part A (partno 0) or B (partno 1) */
+struct AisType24 : AisHeader {
+    typedef AisField<38, 2>                 partno;
+    typedef AisText<40, 20>                 shipname;
+    typedef AisField<40, 8>                 shiptype;
+    typedef AisText<90, 7>                  callsign;
+    typedef AisField<132, 9>                to_bow;
+    typedef AisField<141, 9>                to_stern;
+    typedef AisField<150, 6>                to_port;
+    typedef AisField<156, 6>                to_starboard;
+};
+
+/*
+ * 25: Single slot binary message. The destination (addressed) and the application id
+ * (structured) are optional, so the data offset is only known once both flags are read.
+ */
+struct AisType25 : AisHeader {
+    typedef AisField<38, 1>                 addressed;
+    typedef AisField<39, 1>                 structured;
+    typedef AisField<40, 30>                dst_mmsi;       /* addressed only */
+    static constexpr int data = 40;                         /* broadcast, unstructured */
+    static constexpr int dst_bits = 30;
+    static constexpr int app_id_bits = 16;                  /* DAC 10 + FI 6, structured only */
+    static constexpr int max_bits = 168;
+    static constexpr int data_offset(bool is_addressed, bool is_structured) {
+        return data + (is_addressed ? dst_bits : 0) + (is_structured ? app_id_bits : 0);
+    }
+};
+
+/*
+ * 26: Multiple slot binary message with communication state, same header as 25. The
+ * data is followed by spare bits up to a byte boundary and the 20 bit radio status
+ * (SOTDMA/ITDMA selector and state), which ends the frame.
+ */
+struct AisType26 : AisType25 {
+    static constexpr int radio_bits = 20;
+    static constexpr int max_bits = 1064;                   /* 5 slots */
+};
+
+#endif
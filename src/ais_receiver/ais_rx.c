@@ -1,4 +1,5 @@
 #include "ais_rx.h"
+#include "../BloomFilter.h"
 
 void program_exit(char * str)
 {
@@ -6,20 +7,6 @@ void program_exit(char * str)
     exit(-1);
 }
 
-int unpack_bytes(uint8_t *bit_array, uint8_t *byte_array, int byte_cnt)
-{
-    int nbits = byte_cnt*8;
-    int npad = (6-(nbits % 6)) % 6;
-    int padded_len = nbits+npad;
-    int i;
-    uint8_t bit;
-    for(i = 0; i < nbits; i++) {
-        bit = (byte_array[i/8] >> (7-i%8)) &1;
-        bit_array[i] = bit;
-    }
-    return nbits;
-}
-
 int unpack_bytes_char(char *bit_array, uint8_t *byte_array, int byte_cnt)
 {
     int nbits = byte_cnt*8;
@@ -35,314 +22,121 @@ int unpack_bytes_char(char *bit_array, uint8_t *byte_array, int byte_cnt)
     return nbits;
 }
 
-unsigned long protodec_henten(int from, int size, unsigned char *frame)
-{
-    int i = 0;
-    unsigned long tmp = 0;
-
-    for (i = 0; i < size; i++)
-        tmp |= (frame[from + i]) << (size - 1 - i);
+/*
+ *  Pack a '0'/'1' string into bytes, MSB first, zero padded to a byte boundary.
+ *  This is the canonical form of a frame for the B.F. and HMAC input.
+ */
 
-    return tmp;
+int pack_bits(uint8_t *byte_array, const char *bit_array, int nbits)
+{
+    int nbytes = (nbits + 7) / 8;
+    int i;
+    memset(byte_array, 0, nbytes);
+    for(i = 0; i < nbits; i++) {
+        if (bit_array[i] == '1')
+            byte_array[i/8] |= 1 << (7-i%8);
+    }
+    return nbytes;
 }
 
-void protodec_generate_nmea(demod_state_t *d, int bufferlen, int fillbits)
+/*
+ * Read a size bit field (1..57 bits) starting at bit from of the packed frame, MSB first.
+ * A single unaligned 64-bit big-endian load covers the field; the frame buffer is zero
+ * padded by AIS_FRAME_PADDING bytes so the load never reads past it.
+ */
+unsigned long protodec_henten(int from, int size, const uint8_t *frame)
 {
-    int senlen;
-    int pos;
-    int k, letter;
-    int m;
-    unsigned char sentences, sentencenum, nmeachk;
-    char nchk[NCHK_LEN];
-    int serbuffer_l;
-    int ipcbuffer_l;
-
-    //6bits to nmea-ascii. One sentence len max 82char
-    //inc. head + tail.This makes inside datamax 62char multipart, 62 single
-    senlen = 61;        //this is normally not needed.For testing only. May be fixed number
-    if (bufferlen <= (senlen * 6)) {
-        sentences = 1;
-    } else {
-        sentences = bufferlen / (senlen * 6);
-        //sentences , if overflow put one more
-        if (bufferlen % (senlen * 6) != 0)
-            sentences++;
-    };
-    sentencenum = 0;
-    pos = 0;
-    do {
-        k = 13;     //leave room for nmea header
-        while (k < senlen + 13 && bufferlen > pos) {
-            letter = protodec_henten(pos, 6, d->rbuffer);
-            // 6bit-to-ascii conversion by IEC
-            if (letter < 40)
-                letter = letter + 48;
-            else
-                letter = letter + 56;
-            d->nmea[k] = letter;
-            pos += 6;
-            k++;
-        }
-
-        //set nmea trailer with 00 checksum (calculate later)
-        d->nmea[k] = 44;
-        d->nmea[k + 1] = 48;
-        d->nmea[k + 2] = 42;
-        d->nmea[k + 3] = 48;
-        d->nmea[k + 4] = 48;
-        d->nmea[k + 5] = 0;
-        sentencenum++;
-
-        // printout one frame starts here
-        //AIVDM,x,x,,, - header comes here first
-
-        d->nmea[0] = 65;
-        d->nmea[1] = 73;
-        d->nmea[2] = 86;
-        d->nmea[3] = 68;
-        d->nmea[4] = 77;
-        d->nmea[5] = 44;
-        d->nmea[6] = 48 + sentences;
-        d->nmea[7] = 44;
-        d->nmea[8] = 48 + sentencenum;
-        d->nmea[9] = 44;
-
-        //if multipart message it needs sequential id number
-        if (sentences > 1) {
-            d->nmea[10] = d->seqnr + 48;
-            d->nmea[11] = 44;
-            d->nmea[12] = 44;
-            //and if the last of multipart we need to show fillbits at trailer
-            if (sentencenum == sentences) {
-                d->nmea[k + 1] = 48 + fillbits;
-            }
-        } else {    //else put channel A & no seqnr to keep equal lenght (foo!)
-            d->nmea[10] = 44;
-            d->nmea[11] = 65;
-            d->nmea[12] = 44;
-        }
-        //calculate xor checksum in hex for nmea[0] until nmea[m]='*'(42)
-        nmeachk = d->nmea[0];
-        m = 1;
-        while (d->nmea[m] != 42) {  //!="*"
-            nmeachk = nmeachk ^ d->nmea[m];
-            m++;
-        }
-        // convert calculated checksum to 2 digit hex there are 00 as base
-        // so if only 1 digit put it to later position to get 0-header 01,02...
-        nchk[0] = 0;
-        nchk[1] = 0;
-        snprintf(nchk, NCHK_LEN, "%X", nmeachk);
-        if (nchk[1] == 0) {
-            d->nmea[k + 4] = nchk[0];
-        } else {
-            d->nmea[k + 3] = nchk[0];
-            d->nmea[k + 4] = nchk[1];
-        }
-        //In final. Add header "!" and trailer <cr><lf>
-        // here it could be sent to /dev/ttySx
-    } while (sentencenum < sentences);
+    uint64_t word;
+    memcpy(&word, frame + (from >> 3), sizeof(word));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
+    return (unsigned long)((word << (from & 7)) >> (64 - size));
 }
 
-
-static void remove_trailing_spaces(char *s, int len)
+/*
+ * '0'/'1' string of nbits bits of the frame starting at bit from, only built on demand
+ * for the legacy ASCII B.F./HMAC input and the hex conversion of a CAESAR payload.
+ */
+std::string protodec_bits(const ais_message_t *d, int from, int nbits)
 {
-    int i;
-
-    s[len] = 0;
-    for (i = len-1; i >= 0; i--) {
-        if (s[i] == ' ' || s[i] == 0)
-            s[i] = 0;
-        else
-            i = -1;
-    }
+    std::string bits(nbits, '0');
+    for (int i = 0; i < nbits; i++)
+        bits[i] += (d->frame[(from + i) >> 3] >> (7 - ((from + i) & 7))) & 1;
+    return bits;
 }
 
 /*
- *  Decode 6-bit ASCII to normal 8-bit ASCII
+ *  AIVDM sentences of the frame in nmea (nmea_len bytes), seqnr is the sequential message id
+ *  of multi-sentence messages. Returns the length written, -1 if nmea is too small.
  */
-
-void protodec_decode_sixbit_ascii(char sixbit, char *name, int pos)
+int protodec_generate_nmea(const ais_message_t *d, char *nmea, int nmea_len, int seqnr)
 {
-    if (sixbit >= 1 && sixbit <= 31) {
-        name[pos] = sixbit + 64;
-        return;
-    }
-
-    if (sixbit >= 32 && sixbit <= 63) {
-        name[pos] = sixbit;
-        return;
-    }
-
-    name[pos] = ' ';
+    return nmea_encode(d->frame, d->bit_cnt, seqnr, 'A', nmea, nmea_len);
 }
 
+
 /*
  *  decode position packets (types 1,2,3)
  */
 
-void protodec_pos(demod_state_t *d, int bufferlen, unsigned long mmsi)
+void protodec_pos(ais_message_t *d, int bufferlen, unsigned long mmsi)
 {
-    int longitude, latitude;
-    unsigned short course, sog, heading;
-    char rateofturn, navstat;
-
-    longitude = protodec_henten(61, 28, d->rbuffer);
-    if (((longitude >> 27) & 1) == 1)
-        longitude |= 0xF0000000;
-
-    latitude = protodec_henten(38 + 22 + 29, 27, d->rbuffer);
-    if (((latitude >> 26) & 1) == 1)
-        latitude |= 0xf8000000;
-
-    course = protodec_henten(38 + 22 + 28 + 28, 12, d->rbuffer);
-    sog = protodec_henten(50, 10, d->rbuffer);
-    rateofturn = protodec_henten(38 + 2, 8, d->rbuffer);
-    navstat = protodec_henten(38, 2, d->rbuffer);
-    heading = protodec_henten(38 + 22 + 28 + 28 + 12, 9, d->rbuffer);
-
-    printf(" lat %.6f lon %.6f course %.0f speed %.1f rateofturn %d navstat %d heading %d\n",
-        (float) latitude / 600000.0,
-        (float) longitude / 600000.0,
-        (float) course / 10.0, (float) sog / 10.0,
-        rateofturn, navstat, heading);
+    const uint8_t *f = d->frame;
+
+    printf(" lat %.6f lon %.6f course %.0f speed %.1f rateofturn %ld navstat %ld heading %ld\n",
+        AisType1::lat::value(f),
+        AisType1::lon::value(f),
+        AisType1::course::value(f), AisType1::sog::value(f),
+        AisType1::rateofturn::get(f), AisType1::navstat::get(f), AisType1::heading::get(f));
 }
 
-void protodec_4(demod_state_t *d, int bufferlen, unsigned long mmsi)
+void protodec_4(ais_message_t *d, int bufferlen, unsigned long mmsi)
 {
-    unsigned long day, hour, minute, second, year, month;
-    int longitude, latitude;
-    float longit, latit;
-
-    year = protodec_henten(40, 12, d->rbuffer);
-    month = protodec_henten(52, 4, d->rbuffer);
-    day = protodec_henten(56, 5, d->rbuffer);
-    hour = protodec_henten(61, 5, d->rbuffer);
-    minute = protodec_henten(66, 6, d->rbuffer);
-    second = protodec_henten(72, 6, d->rbuffer);
-
-    longitude = protodec_henten(79, 28, d->rbuffer);
-    if (((longitude >> 27) & 1) == 1)
-        longitude |= 0xF0000000;
-    longit = ((float) longitude) / 10000.0 / 60.0;
-
-    latitude = protodec_henten(107, 27, d->rbuffer);
-    if (((latitude >> 26) & 1) == 1)
-        latitude |= 0xf8000000;
-    latit = ((float) latitude) / 10000.0 / 60.0;
-
-    for (int i = 0; i < bufferlen; i++){
-        d->message += (char)d->rbuffer[i]+48;
-    }
-
-    /*printf(" date %ld-%ld-%ld time %02ld:%02ld:%02ld lat %.6f lon %.6f\n",
-        year, month, day, hour, minute,
-        second, latit, longit);*/
+    /*const uint8_t *f = d->frame;
+    printf(" date %ld-%ld-%ld time %02ld:%02ld:%02ld lat %.6f lon %.6f\n",
+        AisType4::year::get(f), AisType4::month::get(f), AisType4::day::get(f),
+        AisType4::hour::get(f), AisType4::minute::get(f), AisType4::second::get(f),
+        AisType4::lat::value(f), AisType4::lon::value(f));*/
 }
 
-void protodec_5(demod_state_t *d, int bufferlen, unsigned long mmsi)
+void protodec_5(ais_message_t *d, int bufferlen, unsigned long mmsi)
 {
-    int pos;
-    unsigned long imo;
-    char callsign[7];
-    char name[21];
-    char destination[21];
-    unsigned int A, B;
-    unsigned char C, D;
-    unsigned char draught;
-    int k;
-    int letter;
-    unsigned int shiptype;
-
-    /* get IMO number */
-    imo = protodec_henten(40, 30, d->rbuffer);
-    //printf("--- 5: mmsi %lu imo %lu\n", mmsi, imo);
-
-    /* get callsign */
-    pos = 70;
-    for (k = 0; k < 6; k++) {
-        letter = protodec_henten(pos, 6, d->rbuffer);
-        protodec_decode_sixbit_ascii(letter, callsign, k);
-        pos += 6;
-    }
-
-    callsign[6] = 0;
-    remove_trailing_spaces(callsign, 6);
-
-    /* get name */
-    pos = 112;
-    for (k = 0; k < 20; k++) {
-        letter = protodec_henten(pos, 6, d->rbuffer);
-        protodec_decode_sixbit_ascii(letter, name, k);
-        pos += 6;
-    }
-    name[20] = 0;
-    remove_trailing_spaces(name, 20);
-
-    /* get destination */
-    pos = 120 + 106 + 68 + 8;
-    for (k = 0; k < 20; k++) {
-        letter = protodec_henten(pos, 6, d->rbuffer);
-        protodec_decode_sixbit_ascii(letter, destination, k);
-        pos += 6;
-    }
-    destination[20] = 0;
-    remove_trailing_spaces(destination, 20);
-
-    /* type of ship and cargo */
-    shiptype = protodec_henten(232, 8, d->rbuffer);
-
-    /* dimensions and reference GPS position */
-    A = protodec_henten(240, 9, d->rbuffer);
-    B = protodec_henten(240 + 9, 9, d->rbuffer);
-    C = protodec_henten(240 + 9 + 9, 6, d->rbuffer);
-    D = protodec_henten(240 + 9 + 9 + 6, 6, d->rbuffer);
-    draught = protodec_henten(294, 8, d->rbuffer);
-    // printf("Length: %d\nWidth: %d\nDraught: %f\n",A+B,C+D,(float)draught/10);
-
-    printf(" name \"%s\" destination \"%s\" type %d length %d width %d draught %.1f",
-        name, destination, shiptype,
-        A + B, C + D,
-        (float) draught / 10.0);
+    const uint8_t *f = d->frame;
+    char callsign[AisType5::callsign::chars + 1];
+    char name[AisType5::shipname::chars + 1];
+    char destination[AisType5::destination::chars + 1];
+
+    AisType5::callsign::get(f, callsign);
+    AisType5::shipname::get(f, name);
+    AisType5::destination::get(f, destination);
+    //printf("--- 5: mmsi %lu imo %lu\n", mmsi, AisType5::imo::get(f));
+
+    printf(" name \"%s\" destination \"%s\" type %ld length %ld width %ld draught %.1f",
+        name, destination, AisType5::shiptype::get(f),
+        AisType5::to_bow::get(f) + AisType5::to_stern::get(f),
+        AisType5::to_port::get(f) + AisType5::to_starboard::get(f),
+        AisType5::draught::value(f));
 }
 
 /*
  *  6: addressed binary message
  */
 
-void protodec_6(demod_state_t *d, int bufferlen, unsigned long mmsi)
+void protodec_6(ais_message_t *d, int bufferlen, unsigned long mmsi)
 {
- 
-    int sequence = protodec_henten(38, 2, d->rbuffer);
-    unsigned long dst_mmsi = protodec_henten(40, 30, d->rbuffer);
-    unsigned long src_mmsi = protodec_henten(8, 30, d->rbuffer);
-
-   // printf("\n src_mmsi %09ld ",src_mmsi);
+    const uint8_t *f = d->frame;
 
-    for (int i = 0; i < bufferlen; i++){
-        d->message += (char)d->rbuffer[i]+48;
-    }
-
-/*
-    int retransmitted = protodec_henten(70, 1, d->rbuffer);
-    int appid = protodec_henten(72, 16, d->rbuffer);
-    int appid_dac = protodec_henten(72, 10, d->rbuffer);
-    int appid_fi = protodec_henten(82, 6, d->rbuffer);
-*/
   //DEBUG  printf("\nBufferlen:%d\n", bufferlen);
-    //payload at 89 bit
-     strcpy(d->payload_buffer, d->message.substr(88, std::string::npos).c_str()); 
-     //d->payload_buffer = (char *)d->message.substr(88, std::string::npos).c_str();
-
-     d->dst_mmsi = dst_mmsi;
-     d->src_mmsi = src_mmsi;
-     d->sequence = sequence;
-   // string payload = (string) buffer;
-  //  printf("Payload: %s\n", buffer );
+    d->payload_offset = AisType6::data;
+    d->payload_bits = bufferlen > AisType6::data ? bufferlen - AisType6::data : 0;
 
- //   printf(" dst_mmsi %09ld seq %d retransmitted %d appid %d app_dac %d app_fi %d",
-   //     dst_mmsi, sequence, retransmitted, appid, appid_dac, appid_fi);
+    d->dst_mmsi = AisType6::dst_mmsi::get(f);
+    d->src_mmsi = AisType6::mmsi::get(f);
+    d->sequence = AisType6::sequence::get(f);
 
+ //   printf(" dst_mmsi %09ld seq %d retransmitted %ld app_dac %ld app_fi %ld",
+   //     d->dst_mmsi, d->sequence, AisType6::retransmitted::get(f), AisType6::dac::get(f), AisType6::fi::get(f));
 }
 
 /*
@@ -350,19 +144,21 @@ void protodec_6(demod_state_t *d, int bufferlen, unsigned long mmsi)
  *  13: Safety related acknowledge
  */
 
-void protodec_7_13(demod_state_t *d, int bufferlen, unsigned long mmsi)
+void protodec_7_13(ais_message_t *d, int bufferlen, unsigned long mmsi)
 {
+    const int stride = AisType7::ack_stride;
     unsigned long dst_mmsi;
     int sequence;
     int i;
     int pos;
 
-    pos = 40;
+    pos = AisType7::ack_mmsi::offset;
 
-    printf(" buflen %d pos+32 %d", bufferlen, pos + 32);
-    for (i = 0; i < 4 && pos + 32 <= bufferlen; pos += 32) {
-        dst_mmsi = protodec_henten(pos, 30, d->rbuffer);
-        sequence = protodec_henten(pos + 30, 2, d->rbuffer);
+    printf(" buflen %d pos+32 %d", bufferlen, pos + stride);
+    for (i = 0; i < 4 && pos + stride <= bufferlen; pos += stride) {
+        /* block i: same fields as block 0, moved by i * stride */
+        dst_mmsi = protodec_henten(pos, AisType7::ack_mmsi::width, d->frame);
+        sequence = protodec_henten(pos + AisType7::ack_mmsi::width, AisType7::ack_sequence::width, d->frame);
 
         printf(" ack %d (to %09ld seq %d)",
             i+1, dst_mmsi, sequence);
@@ -374,106 +170,101 @@ void protodec_7_13(demod_state_t *d, int bufferlen, unsigned long mmsi)
  *  8: Binary broadcast
  */
 
-void protodec_8(demod_state_t *d, int bufferlen, unsigned long mmsi)
+/*
+ *  CAESAR header (security level + app meta bits) at bit data, payload up to bit data_end
+ */
+
+void protodec_caesar(ais_message_t *d, int data, int data_end)
 {
-    int appid = protodec_henten(40, 16, d->rbuffer);
-    int appid_dac = protodec_henten(40, 10, d->rbuffer);
-    int appid_fi = protodec_henten(50, 6, d->rbuffer);
-    int security_level = protodec_henten(56, 3, d->rbuffer);
-    int appmeta_bits = protodec_henten(59, 5, d->rbuffer);
+    const int header_bits = AisType8::caesar_payload - AisType8::data;
+    int appmeta_bits = protodec_henten(data + AisType8::security_level::width, AisType8::app_meta::width, d->frame);
 
-    d->security_level = security_level;
-    d->appmeta_bits = appmeta_bits;
+    d->security_level = protodec_henten(data, AisType8::security_level::width, d->frame);
+    d->appmeta_bits = appmeta_bits & CAESAR_APPMETA_FILTER;
+    d->encoding = (appmeta_bits & CAESAR_APPMETA_PACKED) ? CAESAR_ENCODING_PACKED : CAESAR_ENCODING_ASCII;
+    d->fragments = (appmeta_bits & CAESAR_APPMETA_FRAGMENTS) >> CAESAR_APPMETA_FRAGMENTS_SHIFT;
 
-    for (int i = 0; i < bufferlen; i++){
-        d->message += (char)d->rbuffer[i]+48;
-    }
-    //CAESAR Message format = security_lvl + appmeta_bits + payload, get payload here 
-    strcpy(d->payload_buffer, d->message.substr(64, std::string::npos).c_str()); 
+    //CAESAR Message format = security_lvl + appmeta_bits + payload, payload span here
+    d->payload_offset = data + header_bits;
+    d->payload_bits = data_end > d->payload_offset ? data_end - d->payload_offset : 0;
+}
+
+void protodec_8(ais_message_t *d, int bufferlen, unsigned long mmsi)
+{
+    protodec_caesar(d, AisType8::data, bufferlen);
+
+    //  printf(" app_dac %ld app_fi %ld\n", AisType8::dac::get(d->frame), AisType8::fi::get(d->frame));
+}
 
-    //  printf(" appid %d app_dac %d app_fi %d app_meta_bits %d \n", appid, appid_dac, appid_fi, appmeta_bits);
+/*
+ *  25: Single slot binary message
+ *  26: Multiple slot binary message with communication state
+ */
+
+void protodec_25_26(ais_message_t *d, int bufferlen, unsigned long mmsi)
+{
+    bool addressed = AisType25::addressed::get(d->frame);
+    bool structured = AisType25::structured::get(d->frame);
+    int data = AisType25::data_offset(addressed, structured);
+    int data_end = bufferlen;
+
+    if (addressed)
+        d->dst_mmsi = AisType25::dst_mmsi::get(d->frame);
+    if (d->type == 26) {
+        /* radio status ends the frame, the spare bits before it only pad the data to a byte */
+        data_end -= AisType26::radio_bits;
+        data_end = data_end > data ? data + (data_end - data) / 8 * 8 : data;
+    }
+    protodec_caesar(d, data, data_end);
 }
 
-void protodec_18(demod_state_t *d, int bufferlen, unsigned long mmsi)
+void protodec_18(ais_message_t *d, int bufferlen, unsigned long mmsi)
 {
-    int longitude, latitude;
-    unsigned short course, sog, heading;
-    char rateofturn, navstat;
-
-    longitude = protodec_henten(57, 28, d->rbuffer);
-    if (((longitude >> 27) & 1) == 1)
-        longitude |= 0xF0000000;
-
-    latitude = protodec_henten(85, 27, d->rbuffer);
-    if (((latitude >> 26) & 1) == 1)
-        latitude |= 0xf8000000;
-
-    course = protodec_henten(112, 12, d->rbuffer);
-    sog = protodec_henten(46, 10, d->rbuffer);
-
-    rateofturn = 0; //NOT in B
-    navstat = 15;   //NOT in B
-
-    heading = protodec_henten(124, 9, d->rbuffer);
-    printf(" lat %.6f lon %.6f course %.0f speed %.1f rateofturn %d navstat %d heading %d\n",
-        (float) latitude / 600000.0,
-        (float) longitude / 600000.0,
-        (float) course / 10.0, (float) sog / 10.0,
-        rateofturn, navstat, heading);
+    const uint8_t *f = d->frame;
+    int rateofturn = 0; //NOT in B
+    int navstat = 15;   //NOT in B
+
+    printf(" lat %.6f lon %.6f course %.0f speed %.1f rateofturn %d navstat %d heading %ld\n",
+        AisType18::lat::value(f),
+        AisType18::lon::value(f),
+        AisType18::course::value(f), AisType18::sog::value(f),
+        rateofturn, navstat, AisType18::heading::get(f));
 }
 
-void protodec_19(demod_state_t *d, int bufferlen, unsigned long mmsi)
+void protodec_19(ais_message_t *d, int bufferlen, unsigned long mmsi)
 {
-    int pos, k;
-    unsigned int A, B;
-    unsigned char C, D;
-    unsigned int shiptype;
-    int letter;
-    char name[21];
+    const uint8_t *f = d->frame;
+    char name[AisType19::shipname::chars + 1];
     /*
      * Class B does not have destination, use "CLASS B" instead
      * (same as ShipPlotter)
      */
     char destination[21] = "CLASS B";
 
-    /* get name */
-    pos = 143;
-    for (k = 0; k < 20; k++) {
-        letter = protodec_henten(pos, 6, d->rbuffer);
-        protodec_decode_sixbit_ascii(letter, name, k);
-        pos += 6;
-    }
-    name[20] = 0;
-    remove_trailing_spaces(name, 20);
+    AisType19::shipname::get(f, name);
     //printf("Name: '%s'\n", name);
 
-    /* type of ship and cargo */
-    shiptype = protodec_henten(263, 8, d->rbuffer);
-
-    /* dimensions and reference GPS position */
-    A = protodec_henten(271, 9, d->rbuffer);
-    B = protodec_henten(271 + 9, 9, d->rbuffer);
-    C = protodec_henten(271 + 9 + 9, 6, d->rbuffer);
-    D = protodec_henten(271 + 9 + 9 + 6, 6, d->rbuffer);
-
-    // printf("Length: %d\nWidth: %d\n",A+B,C+D);
-    //printf("%09ld %d %d %f", mmsi, A + B, C + D);
-    printf(" name \"%s\" type %d length %d  width %d\n", name, shiptype, A+B, C+D);
+    printf(" name \"%s\" type %ld length %ld  width %ld\n", name, AisType19::shiptype::get(f),
+        AisType19::to_bow::get(f) + AisType19::to_stern::get(f),
+        AisType19::to_port::get(f) + AisType19::to_starboard::get(f));
 }
 
-void protodec_20(demod_state_t *d, int bufferlen)
+void protodec_20(ais_message_t *d, int bufferlen)
 {
+    const int stride = AisType20::reserve_stride;
     int ofs, slots, timeout, incr;
     int i;
     int pos;
 
-    pos = 40;
+    pos = AisType20::offset::offset;
 
-    for (i = 0; i < 4 && pos + 30 < bufferlen; pos += 30) {
-        ofs = protodec_henten(pos, 12, d->rbuffer);
-        slots = protodec_henten(pos + 12, 4, d->rbuffer);
-        timeout = protodec_henten(pos + 12 + 4, 3, d->rbuffer);
-        incr = protodec_henten(pos + 12 + 4 + 3, 11, d->rbuffer);
+    for (i = 0; i < 4 && pos + stride < bufferlen; pos += stride) {
+        /* block i: same fields as block 0, moved by i * stride */
+        int shift = pos - AisType20::offset::offset;
+        ofs = protodec_henten(AisType20::offset::offset + shift, AisType20::offset::width, d->frame);
+        slots = protodec_henten(AisType20::slots::offset + shift, AisType20::slots::width, d->frame);
+        timeout = protodec_henten(AisType20::timeout::offset + shift, AisType20::timeout::width, d->frame);
+        incr = protodec_henten(AisType20::increment::offset + shift, AisType20::increment::width, d->frame);
 
         printf(" reserve %d (ofs %d slots %d timeout %d incr %d)",
             i+1, ofs, slots, timeout, incr);
@@ -481,16 +272,11 @@ void protodec_20(demod_state_t *d, int bufferlen)
     }
 }
 
-void protodec_24(demod_state_t *d, int bufferlen, unsigned long mmsi)
+void protodec_24(ais_message_t *d, int bufferlen, unsigned long mmsi)
 {
-    int partnr;
-    int pos;
-    int k, letter;
-    unsigned int A, B;
-    unsigned char C, D;
-    unsigned int shiptype;
-    char name[21];
-    char callsign[7];
+    const uint8_t *f = d->frame;
+    char name[AisType24::shipname::chars + 1];
+    char callsign[AisType24::callsign::chars + 1];
     /*
      * Class B does not have destination, use "CLASS B" instead
      * (same as ShipPlotter)
@@ -498,81 +284,35 @@ void protodec_24(demod_state_t *d, int bufferlen, unsigned long mmsi)
     const char destination[21] = "CLASS B";
 
     /* resolve type 24 frame's part A or B */
-    partnr = protodec_henten(38, 2, d->rbuffer);
+    long partnr = AisType24::partno::get(f);
 
-    //printf("(partnr %d type %d): ",partnr, type);
     if (partnr == 0) {
-        //printf("(Now in name:partnr %d type %d): ",partnr, type);
-        /* get name */
-        pos = 40;
-        for (k = 0; k < 20; k++) {
-            letter = protodec_henten(pos, 6, d->rbuffer);
-            protodec_decode_sixbit_ascii(letter, name, k);
-            pos += 6;
-        }
-
-        name[20] = 0;
-        remove_trailing_spaces(name, 20);
-
+        AisType24::shipname::get(f, name);
         printf(" name \"%s\"", name);
-
     }
 
     if (partnr == 1) {
-        //printf("(Now in data:partnr %d type %d): ",partnr, type);
-        /* get callsign */
-        pos = 90;
-        for (k = 0; k < 6; k++) {
-            letter = protodec_henten(pos, 6, d->rbuffer);
-            protodec_decode_sixbit_ascii(letter, callsign, k);
-            pos += 6;
-        }
-        callsign[6] = 0;
-        remove_trailing_spaces(callsign, 6);
-
-        /* type of ship and cargo */
-        shiptype = protodec_henten(40, 8, d->rbuffer);
-
-        /* dimensions and reference GPS position */
-        A = protodec_henten(132, 9, d->rbuffer);
-        B = protodec_henten(132 + 9, 9, d->rbuffer);
-        C = protodec_henten(132 + 9 + 9, 6, d->rbuffer);
-        D = protodec_henten(132 + 9 + 9 + 6, 6, d->rbuffer);
-
-        printf(" callsign \"%s\" type %d length %d width %d",
-            callsign, shiptype, A+B, C+D);
+        AisType24::callsign::get(f, callsign);
+        printf(" callsign \"%s\" type %ld length %ld width %ld",
+            callsign, AisType24::shiptype::get(f),
+            AisType24::to_bow::get(f) + AisType24::to_stern::get(f),
+            AisType24::to_port::get(f) + AisType24::to_starboard::get(f));
     }
 }
 
 
-void protodec_getdata(int bufferlen, demod_state_t *d)
+void protodec_getdata(int bufferlen, ais_message_t *d)
 {
-    unsigned char type = protodec_henten(0, 6, d->rbuffer);
+    unsigned char type = AisHeader::type::get(d->frame);
     d->type = type;
     if (type < 1 || type > MAX_AIS_PACKET_TYPE /* 4 */)
         return;
-    unsigned long mmsi = protodec_henten(8, 30, d->rbuffer);
-    int fillbits = 0;
-    int k;
+    unsigned long mmsi = AisHeader::mmsi::get(d->frame);
+    //source MMSI is at the same position for every type, type 6/8 keep dst_mmsi as well
+    d->src_mmsi = mmsi;
 
-// Not using this
-/*
-    if (bufferlen % 6 > 0) {
-        fillbits = 6 - (bufferlen % 6);
-        for (k = bufferlen; k < bufferlen + fillbits; k++)
-            d->rbuffer[k] = 0;
-
-        bufferlen = bufferlen + fillbits;
-    }
-*/
-    // generate an NMEA string out of the binary packet 
-   // protodec_generate_nmea(d, bufferlen, fillbits);
-
-    //multipart message ready. Increase seqnr for next one
-    //rolling 1-9. Single msg ready may also increase this, no matter.
-    d->seqnr++;
-    if (d->seqnr > 9)
-        d->seqnr = 0;
+    // generate an NMEA string out of the binary packet, fill bits are added by the encoder
+   // protodec_generate_nmea(d, nmea, sizeof(nmea), seqnr);
 
     if (type < 1 || type > MAX_AIS_PACKET_TYPE)
         return; // unsupported packet type
@@ -623,29 +363,89 @@ void protodec_getdata(int bufferlen, demod_state_t *d)
         protodec_20(d, bufferlen);
         break;
 
+    case 25: /* Single slot binary message */
+    case 26: /* Multiple slot binary message */
+        protodec_25_26(d, bufferlen, mmsi);
+        break;
+
     default:
         break;
     }
 }
 
-int read_ais_message(ais_message_t *ais)
+/*
+ *  Decode the len bytes already in ais->frame
+ */
+void decode_ais_frame(ais_message_t *ais, int len)
+{
+    ais->byte_cnt = len;
+   //DEBUG  printf("\nNumber of bytes:%d",len);
+    /* fields are read straight from the packed bytes, clear what a longer frame left behind */
+    memset(ais->frame + ais->byte_cnt, 0, sizeof(ais->frame) - ais->byte_cnt);
+    ais->bit_cnt = ais->byte_cnt * 8;
+    //DEBUG  printf("\nNumber of bits:%d", ais->bit_cnt);
+
+    /* records are reused, reset the decoded header before filling it */
+    ais->type = 0;
+    ais->sequence = 0;
+    ais->security_level = 0;
+    ais->appmeta_bits = 0;
+    ais->encoding = CAESAR_ENCODING_ASCII;
+    ais->auth = AIS_AUTH_UNVERIFIED;
+    ais->fragments = 0;
+    ais->source = 0;
+    ais->slot = 0;
+    ais->src_mmsi = 0;
+    ais->dst_mmsi = 0;
+    ais->payload_offset = 0;
+    ais->payload_bits = 0;
+
+    protodec_getdata(ais->bit_cnt, ais);
+
+    /* hash the packed frame once, the digest is reused by the filters */
+    ais->digest = CaesarHash::hash(ais->frame, ais->byte_cnt);
+}
+
+int read_ais_message(frame_stream_t *s, ais_message_t *ais)
 {
-    int i;
     int readed;
-    readed = read_kiss_from_socket(ais->fd, (char *) ais->bytebuffer);
+    readed = read_frame_from_stream(s, ais->frame, AIS_MAX_FRAME_BYTES);
     if ( ! (readed > 0) ){
         printf("file descriptor returned error");
         exit(EXIT_FAILURE);
-    }else{
-        /* put each byte sepparatelly */
-        ais->byte_cnt = readed;
-       //DEBUG  printf("\nNumber of bytes:%d",readed);
-        memset(ais->bitbuffer, 0, sizeof(ais->bitbuffer));
-        ais->bit_cnt = unpack_bytes(ais->bitbuffer, ais->bytebuffer, ais->byte_cnt);
-        //DEBUG  printf("\nNumber of bits:%d", ais->bit_cnt);
-        ais->d.rbuffer = ais->bitbuffer;
-        
-        protodec_getdata(ais->bit_cnt, &ais->d);
     }
+    decode_ais_frame(ais, readed);
     return 0;
 }
+
+int read_ais_batch(frame_stream_t *s, ais_message_t *ais, int max_messages)
+{
+    int count, len;
+
+    if (max_messages < 1)
+        return 0;
+    read_ais_message(s, &ais[0]);
+    for (count = 1; count < max_messages; count++) {
+        len = frame_stream_next(s, ais[count].frame, AIS_MAX_FRAME_BYTES);
+        if (len <= 0)
+            break;
+        decode_ais_frame(&ais[count], len);
+    }
+    return count;
+}
+
+int read_ais_message_sources(ais_source_set_t *set, ais_message_t *ais)
+{
+    int len, source;
+
+    do {
+        len = ais_sources_next(set, ais->frame, AIS_MAX_FRAME_BYTES, &source);
+        if (len < 0) {
+            printf("no receive source");
+            exit(EXIT_FAILURE);
+        }
+        decode_ais_frame(ais, len);
+        ais->source = source;
+    } while (ais_sources_duplicate(set, ais->digest, source));
+    return source;
+}
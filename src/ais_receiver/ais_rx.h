@@ -27,39 +27,75 @@
 #include "ais_config.h"
 
 #include "socket_utils.h"
+#include "ais_sources.h"
+#include "ais_fields.h"
 
 #include <string>
 #include <iostream>
+#include <array>
 
-#define     NCHK_LEN                 3
 #define     MAX_AIS_PACKET_TYPE      27
 
 
 #define     MAX_ALLOWABLE_MESSAGES   50
 
-typedef struct demod_state_s{
-    uint8_t     *rbuffer;
-    char        nmea[128];
-    int         seqnr;
-    int type;
-    int sequence;
-    char payload_buffer[1024]={'\0'};
-    unsigned long dst_mmsi;
-    unsigned long src_mmsi;
-    int security_level;
-    int appmeta_bits;
-    std::string message="";
-}demod_state_t;
+/* CAESAR app meta bits, 5 bits following the security level in type 8 */
+#define     CAESAR_APPMETA_FILTER    0x01    /* message carries the separate B.F. (levels 5-7) */
+#define     CAESAR_APPMETA_PACKED    0x02    /* B.F./HMAC input is the packed frame, not the '0'/'1' string */
+#define     CAESAR_APPMETA_FRAGMENTS 0x1c    /* fragments following this one (0..7), 0 in the last or only one */
+#define     CAESAR_APPMETA_FRAGMENTS_SHIFT 2
+#define     CAESAR_MAX_FRAGMENTS     8       /* reassembled frames are still limited to AIS_MAX_FRAME_BYTES */
 
+/* binary messages whose data starts with the CAESAR header: broadcast 8, single/multi slot 25/26 */
+#define     AIS_IS_CAESAR_BINARY(type)  ((type) == 8 || (type) == 25 || (type) == 26)
+
+#define     CAESAR_ENCODING_ASCII    0
+#define     CAESAR_ENCODING_PACKED   1
+
+/* authentication status of a record, set by the receiver once the epoch of the record is checked */
+#define     AIS_AUTH_UNVERIFIED      0       /* unauthenticated: not covered by a verified tag, or verification refused */
+#define     AIS_AUTH_VERIFIED        1       /* authentic */
+#define     AIS_AUTH_FAILED          2       /* key or MAC tag of its epoch does not verify */
+#define     AIS_AUTH_PENDING         3       /* waiting for the disclosure of its epoch */
+
+/* largest frame read from the socket (5 slot messages and longer test PDUs), plus zero padding for the 64-bit field loads */
+#define     AIS_MAX_FRAME_BYTES      256
+#define     AIS_FRAME_PADDING        8
+
+/*
+ * Decoded AIS frame. Plain data only (no pointers or heap members) so records can be
+ * copied, kept in an AisArena and shared between threads without per-message allocations.
+ */
 typedef struct ais_message_s{
-    demod_state_t   d;
-    int             fd;
-    uint8_t         bytebuffer[128]={'\0'};
-    uint8_t         byte_cnt;
-    uint8_t         bitbuffer[1024]={'\0'};
-    uint16_t        bit_cnt;
+    uint8_t     frame[AIS_MAX_FRAME_BYTES + AIS_FRAME_PADDING];  /* packed frame, MSB first, zero padded */
+    uint16_t    byte_cnt;
+    uint16_t    bit_cnt;
+    uint16_t    payload_offset;     /* binary payload span in bits (types 6/8/25/26), 0 bits otherwise */
+    uint16_t    payload_bits;
+    uint8_t     type;
+    uint8_t     sequence;
+    uint8_t     security_level;
+    uint8_t     appmeta_bits;
+    uint8_t     encoding;
+    uint8_t     auth;               /* AIS_AUTH_* */
+    uint8_t     fragments;          /* CAESAR fragments still to come after this frame */
+    uint8_t     source;             /* index of the receive source of the frame */
+    uint32_t    slot;               /* receive slot of the receiver's slot clock (ais_slot_clock.h), set by the receiver */
+    uint32_t    src_mmsi;
+    uint32_t    dst_mmsi;           /* addressed types 6/25/26 */
+    std::array<uint64_t, 2> digest;     /* CaesarHash digest of the packed frame, computed once on decode */
 }ais_message_t;
 
-int read_ais_message(ais_message_t *ais);
+int pack_bits(uint8_t *byte_array, const char *bit_array, int nbits);
+/* decode the len bytes already in ais->frame, the record is reset first */
+void decode_ais_frame(ais_message_t *ais, int len);
+/* next frame of the stream, reading the socket only when no complete frame is buffered */
+int read_ais_message(frame_stream_t *s, ais_message_t *ais);
+/* blocks for one frame, then decodes the frames already buffered: up to max_messages, returns the count */
+int read_ais_batch(frame_stream_t *s, ais_message_t *ais, int max_messages);
+/* next frame of any source (copies of a frame heard by several sources skipped), returns the source index */
+int read_ais_message_sources(ais_source_set_t *set, ais_message_t *ais);
+std::string protodec_bits(const ais_message_t *d, int from, int nbits);
+int protodec_generate_nmea(const ais_message_t *d, char *nmea, int nmea_len, int seqnr);
 
 #endif
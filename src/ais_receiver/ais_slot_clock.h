@@ -0,0 +1,28 @@
+/*
+ *    ais_slot_clock.h
+ *
+ *    AIS TDMA slot clock of the receiver: 2250 slots per minute (26.67 ms) counted from
+ *    CLOCK_MONOTONIC. Windows and budgets kept in slots follow the time on air, so a
+ *    sender cannot move them along by transmitting more frames.
+ */
+
+#ifndef INC_AIS_SLOT_CLOCK_H
+#define INC_AIS_SLOT_CLOCK_H
+
+#include <stdint.h>
+#include <time.h>
+
+#define     AIS_SLOTS_PER_MINUTE     2250
+
+/* slots since an arbitrary origin, wraps after about 3.6 years */
+static inline uint32_t ais_slot_now(void)
+{
+    struct timespec ts;
+    uint64_t ms;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ms = (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+    return (uint32_t)(ms * AIS_SLOTS_PER_MINUTE / 60000);
+}
+
+#endif
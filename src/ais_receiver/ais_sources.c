@@ -0,0 +1,284 @@
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/un.h>
+#include "ais_sources.h"
+
+static long long now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+int ais_sources_init(ais_source_set_t *set)
+{
+    set->count = 0;
+    set->next = 0;
+    set->seen_next = 0;
+    set->duplicates = 0;
+    memset(set->seen, 0, sizeof(set->seen));
+    memset(set->seen_source, 0xff, sizeof(set->seen_source));
+    memset(set->seen_ms, 0, sizeof(set->seen_ms));
+    set->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (set->epfd == -1) {
+        perror("epoll_create1() error");
+        return -1;
+    }
+    return 0;
+}
+
+int ais_sources_add(ais_source_set_t *set, const char *spec, int default_framing)
+{
+    static const struct { const char *prefix; int framing; } framings[] = {
+        {"raw+", AIS_FRAMING_RAW}, {"kiss+", AIS_FRAMING_KISS},
+        {"len+", AIS_FRAMING_LENGTH}, {"nmea+", AIS_FRAMING_NMEA},
+    };
+    ais_source_t *s;
+    const char *p = spec;
+    char *colon;
+    unsigned i;
+
+    if (set->count == AIS_MAX_SOURCES) {
+        printf("Too many sources, %s ignored\n", spec);
+        return -1;
+    }
+    s = &set->sources[set->count];
+    memset(s, 0, sizeof(*s));
+    snprintf(s->spec, sizeof(s->spec), "%s", spec);
+    s->framing = default_framing;
+    for (i = 0; i < sizeof(framings) / sizeof(framings[0]); i++) {
+        if (strncmp(p, framings[i].prefix, strlen(framings[i].prefix)) == 0) {
+            s->framing = framings[i].framing;
+            p += strlen(framings[i].prefix);
+            break;
+        }
+    }
+
+    if (strncmp(p, "tcp:", 4) == 0)
+        s->kind = AIS_SOURCE_TCP;
+    else if (strncmp(p, "udp:", 4) == 0)
+        s->kind = AIS_SOURCE_UDP;
+    else if (strncmp(p, "unix:", 5) == 0)
+        s->kind = AIS_SOURCE_UNIX;
+    else {
+        printf("Unknown source %s\n", spec);
+        return -1;
+    }
+    p = strchr(p, ':') + 1;
+    if (strlen(p) >= AIS_SOURCE_ADDRESS) {
+        printf("Source address too long: %s\n", spec);
+        return -1;
+    }
+    strcpy(s->address, p);
+
+    if (s->kind != AIS_SOURCE_UNIX) {
+        /* host:port, the host may be empty (udp::52001 binds every address) */
+        colon = strrchr(s->address, ':');
+        if (colon == NULL || atoi(colon + 1) <= 0) {
+            printf("Source %s needs host:port\n", spec);
+            return -1;
+        }
+        *colon = 0;
+        s->port = atoi(colon + 1);
+    }
+
+    /* a stream keeps no PDU boundaries: PDUs written close together come in one read */
+    if (s->framing == AIS_FRAMING_RAW && s->kind != AIS_SOURCE_UDP)
+        printf("Warning: source %s reads one PDU per read(), PDUs coalesced by the stream are merged or dropped; "
+               "use udp:, len+ or kiss+ if the sender can frame them\n", spec);
+
+    s->state = AIS_SOURCE_CLOSED;
+    s->backoff_ms = AIS_RECONNECT_MIN_MS;
+    s->retry_at_ms = 0;
+    s->stream.fd = -1;
+    return set->count++;
+}
+
+/*
+ *  Close the socket of a failed source and schedule its reopening, backoff doubles up to AIS_RECONNECT_MAX_MS
+ */
+static void source_fail(ais_source_set_t *set, ais_source_t *s)
+{
+    if (s->stream.fd != -1) {
+        epoll_ctl(set->epfd, EPOLL_CTL_DEL, s->stream.fd, NULL);
+        close(s->stream.fd);
+        s->stream.fd = -1;
+    }
+    s->state = AIS_SOURCE_CLOSED;
+    s->failures++;
+    s->retry_at_ms = now_ms() + s->backoff_ms;
+    s->backoff_ms = s->backoff_ms * 2 > AIS_RECONNECT_MAX_MS ? AIS_RECONNECT_MAX_MS : s->backoff_ms * 2;
+}
+
+static void source_opened(ais_source_set_t *set, ais_source_t *s)
+{
+    struct epoll_event ev;
+
+    s->state = AIS_SOURCE_OPEN;
+    s->connects++;
+    s->backoff_ms = AIS_RECONNECT_MIN_MS;
+    frame_stream_init(&s->stream, s->stream.fd, s->framing);
+    ev.events = EPOLLIN;
+    ev.data.u32 = s - set->sources;
+    epoll_ctl(set->epfd, EPOLL_CTL_MOD, s->stream.fd, &ev);
+    printf("Source %s connected\n", s->spec);
+}
+
+/*
+ *  Start opening a closed source: stream sockets connect without blocking (EPOLLOUT tells
+ *  when the connection is done), UDP sockets are bound and open at once.
+ */
+static void source_open(ais_source_set_t *set, ais_source_t *s)
+{
+    struct epoll_event ev;
+    struct addrinfo hints, *res = NULL;
+    struct sockaddr_un sun;
+    char port[8];
+    int fd, r;
+
+    if (s->kind == AIS_SOURCE_UNIX) {
+        memset(&sun, 0, sizeof(sun));
+        sun.sun_family = AF_UNIX;
+        strncpy(sun.sun_path, s->address, sizeof(sun.sun_path) - 1);
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        r = fd == -1 ? -1 : connect(fd, (struct sockaddr *)&sun, sizeof(sun));
+    } else {
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = s->kind == AIS_SOURCE_UDP ? SOCK_DGRAM : SOCK_STREAM;
+        hints.ai_flags = s->kind == AIS_SOURCE_UDP ? AI_PASSIVE : 0;
+        snprintf(port, sizeof(port), "%d", s->port);
+        if (getaddrinfo(s->address[0] ? s->address : NULL, port, &hints, &res) != 0) {
+            source_fail(set, s);
+            return;
+        }
+        fd = socket(res->ai_family, res->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd != -1 && s->kind == AIS_SOURCE_UDP) {
+            int one = 1;
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+            r = bind(fd, res->ai_addr, res->ai_addrlen);
+        } else {
+            r = fd == -1 ? -1 : connect(fd, res->ai_addr, res->ai_addrlen);
+        }
+        freeaddrinfo(res);
+    }
+
+    s->stream.fd = fd;
+    if (fd == -1 || (r == -1 && errno != EINPROGRESS)) {
+        source_fail(set, s);
+        return;
+    }
+    ev.events = r == 0 ? EPOLLIN : EPOLLOUT;
+    ev.data.u32 = s - set->sources;
+    epoll_ctl(set->epfd, EPOLL_CTL_ADD, fd, &ev);
+    if (r == 0)
+        source_opened(set, s);
+    else
+        s->state = AIS_SOURCE_CONNECTING;
+}
+
+/*
+ *  Socket of s is ready: finish the connection or read what it has queued
+ */
+static void source_event(ais_source_set_t *set, ais_source_t *s, uint32_t events)
+{
+    int err = 0;
+    socklen_t len = sizeof(err);
+
+    if (s->state == AIS_SOURCE_CONNECTING) {
+        getsockopt(s->stream.fd, SOL_SOCKET, SO_ERROR, &err, &len);
+        if (err)
+            source_fail(set, s);
+        else
+            source_opened(set, s);
+        return;
+    }
+    if (s->state != AIS_SOURCE_OPEN)
+        return;
+    if (events & EPOLLIN) {
+        int size = frame_stream_fill(&s->stream);
+        if (size == 0 || (size < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+            printf("Source %s closed, reconnecting in %d ms\n", s->spec, s->backoff_ms);
+            source_fail(set, s);
+        }
+    } else if (events & (EPOLLERR | EPOLLHUP)) {
+        source_fail(set, s);
+    }
+}
+
+int ais_sources_next(ais_source_set_t *set, uint8_t *frame, int max_len, int *source)
+{
+    struct epoll_event events[AIS_MAX_SOURCES];
+    int i, k, n, len, timeout;
+    long long now;
+
+    if (set->count == 0)
+        return -1;
+
+    for (;;) {
+        /* frames already buffered, one source after the other */
+        for (k = 0; k < set->count; k++) {
+            i = (set->next + k) % set->count;
+            if (set->sources[i].state != AIS_SOURCE_OPEN)
+                continue;
+            len = frame_stream_next(&set->sources[i].stream, frame, max_len);
+            if (len > 0) {
+                set->next = (i + 1) % set->count;
+                set->sources[i].frames++;
+                *source = i;
+                return len;
+            }
+        }
+
+        /* reopen the sources whose backoff expired, wait no longer than the next retry */
+        now = now_ms();
+        timeout = -1;
+        for (i = 0; i < set->count; i++) {
+            ais_source_t *s = &set->sources[i];
+            if (s->state == AIS_SOURCE_CLOSED && s->retry_at_ms <= now)
+                source_open(set, s);
+            if (s->state == AIS_SOURCE_CLOSED && (timeout == -1 || s->retry_at_ms - now < timeout))
+                timeout = s->retry_at_ms - now;
+        }
+
+        n = epoll_wait(set->epfd, events, AIS_MAX_SOURCES, timeout);
+        if (n == -1 && errno != EINTR) {
+            perror("epoll_wait() error");
+            return -1;
+        }
+        for (k = 0; k < n; k++)
+            source_event(set, &set->sources[events[k].data.u32], events[k].events);
+    }
+}
+
+bool ais_sources_duplicate(ais_source_set_t *set, const std::array<uint64_t, 2> &digest, int source)
+{
+    long long now = now_ms();
+    int i;
+
+    for (i = 0; i < AIS_SOURCE_DEDUP; i++) {
+        if (set->seen[i] == digest && set->seen_source[i] != source && now - set->seen_ms[i] < AIS_SOURCE_DEDUP_MS) {
+            set->duplicates++;
+            return true;
+        }
+    }
+    set->seen[set->seen_next] = digest;
+    set->seen_source[set->seen_next] = source;
+    set->seen_ms[set->seen_next] = now;
+    set->seen_next = (set->seen_next + 1) % AIS_SOURCE_DEDUP;
+    return false;
+}
+
+void ais_sources_close(ais_source_set_t *set)
+{
+    int i;
+
+    for (i = 0; i < set->count; i++) {
+        if (set->sources[i].stream.fd != -1)
+            close(set->sources[i].stream.fd);
+        set->sources[i].stream.fd = -1;
+        set->sources[i].state = AIS_SOURCE_CLOSED;
+    }
+    close(set->epfd);
+    set->count = 0;
+}
@@ -0,0 +1,96 @@
+/*
+ *    ais_sources.h
+ *
+ *    Receive sources multiplexed with epoll: PDU sockets of several receive chains (AIS
+ *    channels A and B, other SDRs or AIS receivers) feeding one decoder. Connections are
+ *    non-blocking and a source that fails or closes is reopened with exponential backoff,
+ *    so one missing flowgraph never blocks the others.
+ *
+ *    Source specs: [raw+|kiss+|len+|nmea+]tcp:host:port, udp:host:port (bound, datagrams
+ *    received on it), unix:path. Without a framing prefix the default framing is used.
+ */
+
+#ifndef INC_AIS_SOURCES_H
+#define INC_AIS_SOURCES_H
+
+#include <stdint.h>
+#include <array>
+
+#include "socket_utils.h"
+
+#define     AIS_MAX_SOURCES          16
+#define     AIS_SOURCE_ADDRESS       108     /* sun_path */
+
+#define     AIS_SOURCE_TCP           0
+#define     AIS_SOURCE_UDP           1
+#define     AIS_SOURCE_UNIX          2
+
+#define     AIS_SOURCE_CLOSED        0
+#define     AIS_SOURCE_CONNECTING    1
+#define     AIS_SOURCE_OPEN          2
+
+#ifndef AIS_RECONNECT_MIN_MS
+#define     AIS_RECONNECT_MIN_MS     250
+#endif
+#ifndef AIS_RECONNECT_MAX_MS
+#define     AIS_RECONNECT_MAX_MS     8000
+#endif
+
+/*
+ * The same transmission heard by several sources is passed on once. Copies arrive within
+ * a few ms, identical frames sent again are at least one AIS slot (26.7 ms) apart.
+ */
+#define     AIS_SOURCE_DEDUP         32      /* frames remembered */
+#ifndef AIS_SOURCE_DEDUP_MS
+#define     AIS_SOURCE_DEDUP_MS      20
+#endif
+
+typedef struct ais_source_s{
+    char            spec[AIS_SOURCE_ADDRESS + 16];
+    int             kind;
+    int             state;
+    int             framing;
+    char            address[AIS_SOURCE_ADDRESS];
+    int             port;
+    int             backoff_ms;
+    long long       retry_at_ms;
+    unsigned long   frames;
+    unsigned long   connects;
+    unsigned long   failures;
+    frame_stream_t  stream;             /* stream.fd is -1 while closed */
+}ais_source_t;
+
+typedef struct ais_source_set_s{
+    int             epfd;
+    int             count;
+    int             next;               /* first source served when several have frames buffered */
+    ais_source_t    sources[AIS_MAX_SOURCES];
+    std::array<uint64_t, 2> seen[AIS_SOURCE_DEDUP];
+    uint8_t         seen_source[AIS_SOURCE_DEDUP];
+    long long       seen_ms[AIS_SOURCE_DEDUP];
+    int             seen_next;
+    unsigned long   duplicates;
+}ais_source_set_t;
+
+/* returns 0, -1 if epoll is not available */
+int ais_sources_init(ais_source_set_t *set);
+
+/* add a source from its spec, opened on the first ais_sources_next(); its index or -1 */
+int ais_sources_add(ais_source_set_t *set, const char *spec, int default_framing);
+
+/*
+ *  Next frame of any source, blocking until one is complete. Sources with buffered frames
+ *  are served in turn; closed sources are reopened when their backoff expires.
+ *  Returns the frame length and the source index in *source, -1 if no source was added.
+ */
+int ais_sources_next(ais_source_set_t *set, uint8_t *frame, int max_len, int *source);
+
+/*
+ *  true if the frame of digest was passed on from another source less than AIS_SOURCE_DEDUP_MS
+ *  ago, otherwise it is remembered for source
+ */
+bool ais_sources_duplicate(ais_source_set_t *set, const std::array<uint64_t, 2> &digest, int source);
+
+void ais_sources_close(ais_source_set_t *set);
+
+#endif
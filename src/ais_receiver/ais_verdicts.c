@@ -0,0 +1,66 @@
+#include <string.h>
+#include <unistd.h>
+#include "ais_verdicts.h"
+
+static_assert(sizeof(ais_verdict_t) == 24, "verdict records are 24 bytes on the wire");
+
+int ais_verdicts_open(ais_verdict_stream_t *s, const char *path)
+{
+    memset(s, 0, sizeof(*s));
+    s->fd = -1;
+    if (path == NULL || path[0] == 0)
+        return 0;
+    if (strlen(path) >= sizeof(s->addr.sun_path)) {
+        printf("verdict socket path too long: %s\n", path);
+        return -1;
+    }
+    s->fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (s->fd == -1) {
+        perror("socket() error");
+        return -1;
+    }
+    s->addr.sun_family = AF_UNIX;
+    strcpy(s->addr.sun_path, path);
+    s->addr_len = sizeof(s->addr);
+    return 0;
+}
+
+void ais_verdicts_add(ais_verdict_stream_t *s, const ais_message_t *m, uint8_t verdict)
+{
+    ais_verdict_t *v;
+
+    if (s->fd == -1)
+        return;
+    v = &s->batch[s->count++];
+    v->digest = m->digest[0];
+    v->mmsi = m->src_mmsi;
+    v->slot = m->slot;
+    v->verdict = verdict;
+    v->type = m->type;
+    v->security_level = m->security_level;
+    v->source = m->source;
+    v->reserved = 0;
+    if (s->count == AIS_VERDICT_BATCH)
+        ais_verdicts_flush(s);
+}
+
+void ais_verdicts_flush(ais_verdict_stream_t *s)
+{
+    if (s->fd == -1 || s->count == 0)
+        return;
+    /* no reader bound yet (ENOENT, ECONNREFUSED) or its buffer is full (EAGAIN): the batch is dropped */
+    if (sendto(s->fd, s->batch, s->count * sizeof(ais_verdict_t), MSG_DONTWAIT | MSG_NOSIGNAL,
+               (struct sockaddr *)&s->addr, s->addr_len) == (ssize_t)(s->count * sizeof(ais_verdict_t)))
+        s->sent += s->count;
+    else
+        s->dropped += s->count;
+    s->count = 0;
+}
+
+void ais_verdicts_close(ais_verdict_stream_t *s)
+{
+    ais_verdicts_flush(s);
+    if (s->fd != -1)
+        close(s->fd);
+    s->fd = -1;
+}
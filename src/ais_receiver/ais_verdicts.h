@@ -0,0 +1,56 @@
+/*
+ *    ais_verdicts.h
+ *
+ *    Authentication verdicts of the received messages as a stream of fixed size binary
+ *    records on a local datagram socket. A message is published as pending when it is
+ *    received and again once its epoch is verified, failed or refused, so a consumer
+ *    never waits for the verification. Records are batched per sending thread and sent
+ *    without blocking: with no reader, or a reader that does not keep up, they are dropped
+ *    and counted.
+ */
+
+#ifndef INC_AIS_VERDICTS_H
+#define INC_AIS_VERDICTS_H
+
+#include <stdint.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "ais_rx.h"
+
+#define     AIS_VERDICT_BATCH        64      /* records per datagram, 1536 bytes */
+
+/* one record, little endian as written by the receiver */
+typedef struct ais_verdict_s{
+    uint64_t    digest;             /* first word of the CaesarHash digest of the frame */
+    uint32_t    mmsi;
+    uint32_t    slot;               /* receive slot of the frame */
+    uint8_t     verdict;            /* AIS_AUTH_* */
+    uint8_t     type;
+    uint8_t     security_level;
+    uint8_t     source;
+    uint32_t    reserved;
+}ais_verdict_t;
+
+typedef struct ais_verdict_stream_s{
+    int                 fd;         /* -1 when the stream is disabled */
+    struct sockaddr_un  addr;
+    socklen_t           addr_len;
+    int                 count;
+    ais_verdict_t       batch[AIS_VERDICT_BATCH];
+    unsigned long       sent;       /* records */
+    unsigned long       dropped;
+}ais_verdict_stream_t;
+
+/* stream to the datagram socket bound at path by the consumer; NULL or "" disables it. 0, -1 on error */
+int ais_verdicts_open(ais_verdict_stream_t *s, const char *path);
+
+/* queue the verdict of a message, the batch is sent once full */
+void ais_verdicts_add(ais_verdict_stream_t *s, const ais_message_t *m, uint8_t verdict);
+
+/* send the records queued so far */
+void ais_verdicts_flush(ais_verdict_stream_t *s);
+
+void ais_verdicts_close(ais_verdict_stream_t *s);
+
+#endif
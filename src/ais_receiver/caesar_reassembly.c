@@ -0,0 +1,151 @@
+#include <string.h>
+#include "caesar_reassembly.h"
+
+void caesar_reassembly_init(caesar_reassembly_t *r)
+{
+    int b, w;
+
+    for (b = 0; b < CAESAR_REASSEMBLY_BUCKETS; b++) {
+        for (w = 0; w < CAESAR_REASSEMBLY_WAYS; w++) {
+            r->ways[b][w].remaining = 0;
+            r->ways[b][w].mmsi = 0;
+            r->ways[b][w].last_slot = 0;
+        }
+    }
+    r->now = 0;
+    r->fragments = 0;
+    r->messages = 0;
+    r->dropped = 0;
+    r->full = 0;
+}
+
+void caesar_reassembly_advance(caesar_reassembly_t *r, uint32_t slot)
+{
+    r->now = slot;
+}
+
+static caesar_partial_t *partial_bucket(caesar_reassembly_t *r, uint32_t mmsi)
+{
+    /* high bits of the multiplicative hash scaled to the bucket count */
+    return r->ways[((uint64_t)(uint32_t)(mmsi * 2654435761u) * CAESAR_REASSEMBLY_BUCKETS) >> 32];
+}
+
+static bool partial_active(const caesar_reassembly_t *r, const caesar_partial_t *p)
+{
+    return p->remaining && r->now - p->last_slot <= CAESAR_REASSEMBLY_TIMEOUT;
+}
+
+/*
+ *  Way of the bucket of mmsi holding its partial payload, NULL if there is none.
+ *  Timed out payloads are released (and counted) as they are found.
+ */
+static caesar_partial_t *partial_find(caesar_reassembly_t *r, uint32_t mmsi)
+{
+    caesar_partial_t *ways = partial_bucket(r, mmsi);
+    int w;
+
+    for (w = 0; w < CAESAR_REASSEMBLY_WAYS; w++) {
+        if (!ways[w].remaining)
+            continue;
+        if (!partial_active(r, &ways[w])) {
+            ways[w].remaining = 0;
+            r->dropped++;
+            continue;
+        }
+        if (ways[w].mmsi == mmsi)
+            return &ways[w];
+    }
+    return NULL;
+}
+
+/*
+ *  Free way of the bucket of mmsi, NULL if all are in use (timed out ways were freed by partial_find)
+ */
+static caesar_partial_t *partial_alloc(caesar_reassembly_t *r, uint32_t mmsi)
+{
+    caesar_partial_t *ways = partial_bucket(r, mmsi);
+    int w;
+
+    for (w = 0; w < CAESAR_REASSEMBLY_WAYS; w++) {
+        if (!ways[w].remaining)
+            return &ways[w];
+    }
+    return NULL;
+}
+
+int caesar_reassembly_add(caesar_reassembly_t *r, ais_message_t *d)
+{
+    caesar_partial_t *p;
+    int header_bytes, payload_bytes;
+
+    if (!AIS_IS_CAESAR_BINARY(d->type))
+        return 1;
+
+    p = partial_find(r, d->src_mmsi);
+    if (p && (d->fragments != p->remaining - 1 || d->type != p->type || d->security_level != p->security_level)) {
+        /* gap in the fragments: the partial payload can not be completed anymore */
+        p->remaining = 0;
+        r->dropped++;
+        p = NULL;
+        /* a last fragment after a gap is not a message on its own */
+        if (!d->fragments)
+            return -1;
+    }
+    if (!p && !d->fragments)
+        return 1;
+
+    /* fragments are joined on byte boundaries, as the transmitter splits them */
+    header_bytes = d->payload_offset / 8;
+    payload_bytes = d->payload_bits / 8;
+    if ((d->payload_offset | d->payload_bits) & 7)
+        goto drop;
+
+    if (!p) {
+        p = partial_alloc(r, d->src_mmsi);
+        if (!p) {
+            r->full++;
+            return -1;
+        }
+        memcpy(p->frame, d->frame, header_bytes);
+        /* the reassembled frame reads as a single, unfragmented message */
+        p->frame[header_bytes - 1] &= ~CAESAR_APPMETA_FRAGMENTS;
+        p->byte_cnt = header_bytes;
+        p->payload_offset = d->payload_offset;
+        p->mmsi = d->src_mmsi;
+        p->type = d->type;
+        p->security_level = d->security_level;
+        p->hash.reset();
+        p->hash.process(p->frame, header_bytes);
+    }
+
+    if (p->byte_cnt + payload_bytes > AIS_MAX_FRAME_BYTES) {
+        p->remaining = 0;
+        goto drop;
+    }
+    memcpy(p->frame + p->byte_cnt, d->frame + header_bytes, payload_bytes);
+    p->hash.process(p->frame + p->byte_cnt, payload_bytes);
+    p->byte_cnt += payload_bytes;
+    p->last_slot = r->now;
+    r->fragments++;
+
+    if (d->fragments) {
+        p->remaining = d->fragments;
+        return 0;
+    }
+
+    /* last fragment: the record becomes the whole message, header fields of the first fragment */
+    p->remaining = 0;
+    memcpy(d->frame, p->frame, p->byte_cnt);
+    memset(d->frame + p->byte_cnt, 0, sizeof(d->frame) - p->byte_cnt);
+    d->byte_cnt = p->byte_cnt;
+    d->bit_cnt = p->byte_cnt * 8;
+    d->payload_offset = p->payload_offset;
+    d->payload_bits = d->bit_cnt - p->payload_offset;
+    d->digest = p->hash.result();
+    r->messages++;
+    return 1;
+
+drop:
+    r->dropped++;
+    return -1;
+}
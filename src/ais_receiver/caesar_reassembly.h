@@ -0,0 +1,67 @@
+/*
+ *    caesar_reassembly.h
+ *
+ *    Reassembly of CAESAR payloads sent over several binary messages (8, 25, 26). Every
+ *    fragment repeats the CAESAR header with the number of fragments that follow it in the
+ *    app meta bits. Partial payloads are kept per source MMSI in a set-associative table
+ *    sized for CAESAR_REASSEMBLY_VESSELS senders, so a fragment is placed with one bucket
+ *    lookup and one copy, and are dropped when the next fragment does not arrive within
+ *    CAESAR_REASSEMBLY_TIMEOUT slots of the receiver's slot clock, however many frames of
+ *    other senders and sources come in between. A first fragment that finds its bucket full is
+ *    dropped: payloads still in time are never evicted, so a flood of first fragments
+ *    cannot break the reassembly of the senders already in the table.
+ */
+
+#ifndef INC_CAESAR_REASSEMBLY_H
+#define INC_CAESAR_REASSEMBLY_H
+
+#include <stdint.h>
+
+#include "ais_rx.h"
+#include "../BloomFilter.h"
+
+#ifndef CAESAR_REASSEMBLY_VESSELS
+#define     CAESAR_REASSEMBLY_VESSELS   4096    /* senders with a partial payload at once */
+#endif
+#define     CAESAR_REASSEMBLY_WAYS      4       /* partial payloads per bucket */
+#define     CAESAR_REASSEMBLY_BUCKETS   ((CAESAR_REASSEMBLY_VESSELS + CAESAR_REASSEMBLY_WAYS - 1) / CAESAR_REASSEMBLY_WAYS)
+
+#ifndef CAESAR_REASSEMBLY_TIMEOUT
+#define     CAESAR_REASSEMBLY_TIMEOUT   225     /* slots (6 s) between two fragments of a payload */
+#endif
+
+typedef struct caesar_partial_s{
+    uint8_t             frame[AIS_MAX_FRAME_BYTES]; /* header of the first fragment, then the payloads */
+    uint16_t            byte_cnt;
+    uint16_t            payload_offset;
+    uint32_t            mmsi;
+    uint8_t             remaining;                  /* fragments still expected, 0 when the way is free */
+    uint8_t             type;
+    uint8_t             security_level;
+    uint32_t            last_slot;                  /* arrival of the latest fragment */
+    CaesarHash::Stream  hash;                       /* digest of frame, updated per fragment */
+}caesar_partial_t;
+
+typedef struct caesar_reassembly_s{
+    caesar_partial_t    ways[CAESAR_REASSEMBLY_BUCKETS][CAESAR_REASSEMBLY_WAYS];
+    uint32_t            now;                        /* slot of the latest frame */
+    unsigned long       fragments;                  /* fragments stored */
+    unsigned long       messages;                   /* payloads completed */
+    unsigned long       dropped;                    /* partial payloads lost (gap, timeout, too long) */
+    unsigned long       full;                       /* first fragments dropped, bucket full */
+}caesar_reassembly_t;
+
+void caesar_reassembly_init(caesar_reassembly_t *r);
+
+/* a frame has been received at slot of the slot clock (ais_slot_now()) */
+void caesar_reassembly_advance(caesar_reassembly_t *r, uint32_t slot);
+
+/*
+ *  Offer a decoded record. Returns 1 if d holds a complete message: any frame that is not
+ *  a CAESAR fragment, or the last fragment, whose record is then rewritten as the reassembled
+ *  frame (header of the first fragment, payloads in order, digest of the whole frame).
+ *  Returns 0 if d was a fragment kept for reassembly, -1 if it was dropped.
+ */
+int caesar_reassembly_add(caesar_reassembly_t *r, ais_message_t *d);
+
+#endif
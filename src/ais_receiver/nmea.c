@@ -0,0 +1,245 @@
+#include <string.h>
+#include "nmea.h"
+
+static constexpr NmeaArmorTable nmea_armor;
+static constexpr NmeaArmorPairs nmea_armor_pairs;
+static const char nmea_hex[] = "0123456789ABCDEF";
+
+void nmea_reassembly_init(nmea_reassembly_t *r)
+{
+    memset(r, 0, sizeof(*r));
+}
+
+static int hex_value(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    return -1;
+}
+
+/*
+ *  Append n armor characters to the packed bits of buf, starting at bit bitpos.
+ *  Bits after the last one written are cleared. Returns the new bit position, -1 on an
+ *  invalid character or if max_bits would be exceeded.
+ */
+static int armor_append(uint8_t *buf, int bitpos, int max_bits, const char *s, int n)
+{
+    uint8_t *out = buf + (bitpos >> 3);
+    int accbits = bitpos & 7;
+    uint32_t acc = 0;
+    int i;
+
+    if (bitpos + 6 * n > max_bits)
+        return -1;
+    if (accbits)
+        acc = *out >> (8 - accbits);
+    for (i = 0; i < n; i++) {
+        int v = nmea_armor.v[(uint8_t)s[i]];
+        if (v < 0)
+            return -1;
+        acc = (acc << 6) | v;
+        accbits += 6;
+        if (accbits >= 8) {
+            accbits -= 8;
+            *out++ = acc >> accbits;
+        }
+    }
+    if (accbits)
+        *out = acc << (8 - accbits);
+    return bitpos + 6 * n;
+}
+
+/*
+ *  Copy a complete message of bits bits to frame, clearing the fill bits.
+ */
+static int finish_message(nmea_reassembly_t *r, const uint8_t *bytes, int bits, uint8_t *frame, int max_len)
+{
+    int len = (bits + 7) / 8;
+
+    if (bits <= 0 || len > max_len) {
+        r->bad_sentences++;
+        return -1;
+    }
+    if (bytes != frame)
+        memcpy(frame, bytes, len);
+    if (bits & 7)
+        frame[len - 1] &= 0xff << (8 - (bits & 7));
+    r->messages++;
+    return len;
+}
+
+int nmea_decode_sentence(nmea_reassembly_t *r, const char *line, int len, uint8_t *frame, int max_len)
+{
+    const char *p = line;
+    const char *end = line + len;
+    const char *star, *payload;
+    int payload_len, count, num, seqid, channel, fill, bits;
+    uint8_t chk;
+    nmea_fragment_t *slot;
+
+    /* skip tag blocks and anything else before the start delimiter */
+    while (p < end && *p != '!' && *p != '$')
+        p++;
+    if (p == end)
+        return -1;
+    r->sentences++;
+
+    /* checksum: XOR of everything between the delimiter and '*' */
+    chk = 0;
+    for (star = p + 1; star < end && *star != '*'; star++)
+        chk ^= *star;
+    if (end - star < 3 || hex_value(star[1]) < 0 || hex_value(star[2]) < 0 ||
+        ((hex_value(star[1]) << 4) | hex_value(star[2])) != chk)
+        goto bad;
+
+    /* !ccVDM or !ccVDO, then count,num,seqid,channel,payload,fill */
+    if (star - p < 16 || p[3] != 'V' || p[4] != 'D' || (p[5] != 'M' && p[5] != 'O') || p[6] != ',')
+        goto bad;
+    p += 7;
+    if (p[0] < '1' || p[0] > '9' || p[1] != ',' || p[2] < '1' || p[2] > '9' || p[3] != ',')
+        goto bad;
+    count = p[0] - '0';
+    num = p[2] - '0';
+    p += 4;
+    seqid = 0;
+    if (*p >= '0' && *p <= '9')
+        seqid = *p++ - '0';
+    if (*p++ != ',')
+        goto bad;
+    channel = 2;
+    if (*p != ',') {
+        channel = (*p == 'A' || *p == '1') ? 0 : (*p == 'B' || *p == '2') ? 1 : 2;
+        p++;
+    }
+    if (*p++ != ',')
+        goto bad;
+    payload = p;
+    while (p < star && *p != ',')
+        p++;
+    payload_len = p - payload;
+    if (p + 2 != star || p[1] < '0' || p[1] > '5' || num > count)
+        goto bad;
+    fill = p[1] - '0';
+
+    if (count == 1) {
+        bits = armor_append(frame, 0, max_len * 8, payload, payload_len);
+        if (bits < 0)
+            goto bad;
+        return finish_message(r, frame, bits - fill, frame, max_len);
+    }
+
+    slot = &r->slots[seqid][channel];
+    if (num == 1) {
+        if (slot->count)
+            r->dropped_fragments++;     /* previous message never completed */
+        slot->count = count;
+        slot->next = 1;
+        slot->bit_cnt = 0;
+    } else if (slot->count != count || slot->next != num) {
+        r->dropped_fragments++;
+        slot->count = 0;
+        return -1;
+    }
+
+    bits = armor_append(slot->bytes, slot->bit_cnt, NMEA_MAX_MESSAGE_BYTES * 8, payload, payload_len);
+    if (bits < 0) {
+        slot->count = 0;
+        goto bad;
+    }
+    slot->bit_cnt = bits - fill;
+    if (++slot->next <= slot->count)
+        return 0;
+
+    slot->count = 0;
+    return finish_message(r, slot->bytes, slot->bit_cnt, frame, max_len);
+
+bad:
+    r->bad_sentences++;
+    return -1;
+}
+
+/*
+ *  Six bits at bit pos of the frame, bits at or after bits read as 0.
+ */
+static int sixbit_at(const uint8_t *frame, int pos, int bits)
+{
+    int v = 0;
+    int k;
+
+    for (k = pos; k < pos + 6; k++)
+        v = (v << 1) | (k < bits ? (frame[k >> 3] >> (7 - (k & 7))) & 1 : 0);
+    return v;
+}
+
+int nmea_encode(const uint8_t *frame, int bits, int seqid, char channel, char *out, int out_len)
+{
+    int chars = (bits + 5) / 6;
+    int fill = chars * 6 - bits;
+    int sentences = (chars + NMEA_MAX_PAYLOAD_CHARS - 1) / NMEA_MAX_PAYLOAD_CHARS;
+    char *o = out;
+    char *end = out + out_len;
+    int n, i;
+
+    if (chars == 0 || sentences > 9)
+        return -1;
+
+    for (n = 0; n < sentences; n++) {
+        int first = n * NMEA_MAX_PAYLOAD_CHARS;
+        int nch = chars - first < NMEA_MAX_PAYLOAD_CHARS ? chars - first : NMEA_MAX_PAYLOAD_CHARS;
+        /* payload start is byte aligned: NMEA_MAX_PAYLOAD_CHARS * 6 is a multiple of 24 */
+        const uint8_t *p = frame + first * 6 / 8;
+        int pos = first * 6;
+        char *start = o;
+        uint8_t chk = 0;
+
+        /* "!AIVDM,n,i,s,c," payload ",f*hh\r\n" NUL */
+        if (end - o < nch + 25)
+            return -1;
+        *o++ = '!';
+        memcpy(o, "AIVDM,", 6);
+        o += 6;
+        *o++ = '0' + sentences;
+        *o++ = ',';
+        *o++ = '1' + n;
+        *o++ = ',';
+        if (sentences > 1)
+            *o++ = '0' + seqid % 10;
+        *o++ = ',';
+        if (channel)
+            *o++ = channel;
+        *o++ = ',';
+        for (start++; start < o; start++)
+            chk ^= *start;
+
+        /* 3 bytes -> 4 characters while all 24 bits belong to the frame */
+        for (i = 0; i + 4 <= nch && pos + 24 <= bits; i += 4, pos += 24, p += 3) {
+            const char *hi = nmea_armor_pairs.c[(p[0] << 4) | (p[1] >> 4)];
+            const char *lo = nmea_armor_pairs.c[((p[1] & 0x0f) << 8) | p[2]];
+            o[0] = hi[0];
+            o[1] = hi[1];
+            o[2] = lo[0];
+            o[3] = lo[1];
+            chk ^= hi[0] ^ hi[1] ^ lo[0] ^ lo[1];
+            o += 4;
+        }
+        for (; i < nch; i++, pos += 6) {
+            *o = NmeaArmorPairs::armor(sixbit_at(frame, pos, bits));
+            chk ^= *o++;
+        }
+
+        *o++ = ',';
+        *o = '0' + (n == sentences - 1 ? fill : 0);
+        chk ^= ',' ^ *o++;
+        *o++ = '*';
+        *o++ = nmea_hex[chk >> 4];
+        *o++ = nmea_hex[chk & 0x0f];
+        *o++ = '\r';
+        *o++ = '\n';
+    }
+    *o = 0;
+    return o - out;
+}
@@ -0,0 +1,76 @@
+/*
+ *    nmea.h
+ *
+ *    NMEA 0183 AIVDM/AIVDO input: checksum validation, six-bit armor decoding straight
+ *    into packed frame bytes and reassembly of multi-sentence messages, keyed by sequential
+ *    message id and radio channel.
+ *    Output: table-driven armoring of packed frames into AIVDM sentences.
+ */
+
+#ifndef INC_NMEA_H
+#define INC_NMEA_H
+
+#include <stdint.h>
+
+#define     NMEA_MAX_FRAGMENTS       9
+#define     NMEA_SEQUENCE_IDS        10      /* sequential message id 0..9 */
+#define     NMEA_CHANNELS            3       /* A, B, anything else (or empty) */
+#define     NMEA_MAX_MESSAGE_BYTES   256
+#define     NMEA_MAX_PAYLOAD_CHARS   60      /* armor characters per sentence, 360 bits = 45 bytes */
+
+/* six-bit armor character to its value, -1 if the character is not valid armor */
+struct NmeaArmorTable {
+    int8_t v[256];
+    constexpr NmeaArmorTable() : v() {
+        for (int c = 0; c < 256; c++)
+            v[c] = (c >= 48 && c <= 87) ? c - 48 : (c >= 96 && c <= 119) ? c - 56 : -1;
+    }
+};
+
+/* 12 bits to their two armor characters, so 3 frame bytes are armored with 2 lookups */
+struct NmeaArmorPairs {
+    char c[4096][2];
+    static constexpr char armor(int v) { return v < 40 ? v + 48 : v + 56; }
+    constexpr NmeaArmorPairs() : c() {
+        for (int i = 0; i < 4096; i++) {
+            c[i][0] = armor(i >> 6);
+            c[i][1] = armor(i & 63);
+        }
+    }
+};
+
+typedef struct nmea_fragment_s{
+    uint8_t     bytes[NMEA_MAX_MESSAGE_BYTES];  /* packed bits of the fragments received so far */
+    int         bit_cnt;
+    uint8_t     count;                          /* fragments of the message, 0 when the slot is free */
+    uint8_t     next;                           /* number of the next expected fragment */
+}nmea_fragment_t;
+
+typedef struct nmea_reassembly_s{
+    nmea_fragment_t slots[NMEA_SEQUENCE_IDS][NMEA_CHANNELS];
+    unsigned long   sentences;                  /* sentences parsed */
+    unsigned long   messages;                   /* complete messages returned */
+    unsigned long   bad_sentences;              /* checksum, syntax or armor errors */
+    unsigned long   dropped_fragments;          /* out of order or orphan fragments */
+}nmea_reassembly_t;
+
+void nmea_reassembly_init(nmea_reassembly_t *r);
+
+/*
+ *  Decode one sentence (without line terminator, leading tag blocks are skipped).
+ *  Returns the length in bytes of the packed frame written to frame once a message is
+ *  complete, 0 if the sentence was a fragment kept for reassembly, -1 if it was rejected.
+ *  Unused bits of the last byte are zero, as in the frames of the GNU Radio socket.
+ */
+int nmea_decode_sentence(nmea_reassembly_t *r, const char *line, int len, uint8_t *frame, int max_len);
+
+/*
+ *  Armor the first bits bits of a packed frame into "!AIVDM,n,i,s,c,payload,fill*hh\r\n"
+ *  sentences of at most NMEA_MAX_PAYLOAD_CHARS characters, concatenated and NUL terminated
+ *  in out. The checksum is computed while the sentence is written. seqid (0..9) is only
+ *  written for multi-sentence messages, channel may be 0 for none.
+ *  Returns the length written, -1 if out_len is too small or the frame needs more than 9 sentences.
+ */
+int nmea_encode(const uint8_t *frame, int bits, int seqid, char channel, char *out, int out_len);
+
+#endif
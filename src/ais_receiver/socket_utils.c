@@ -6,6 +6,7 @@
 //  Copyright (c) 2014 Juan Fran Muñoz Martin. All rights reserved.
 //
 
+#include <errno.h>
 #include "socket_utils.h"
 
 #define FEND    0xC0
@@ -13,146 +14,205 @@
 #define TFEND   0xDC
 #define TFESC   0xDD
 
-#if 0
-int read_kiss_from_socket(int fd, char * buffer){
-    int i;
-    int out_size;
+void frame_stream_init(frame_stream_t *s, int fd, int framing)
+{
+    s->fd = fd;
+    s->framing = framing;
+    s->head = 0;
+    s->tail = 0;
+    if (framing == AIS_FRAMING_NMEA)
+        nmea_reassembly_init(&s->nmea);
+}
+
+/*
+ *  One read() of as much as fits in the buffer, after moving the unparsed bytes to its start.
+ *  Returns the number of bytes read, 0 at the end of the socket and -1 on error (or EAGAIN).
+ */
+int frame_stream_fill(frame_stream_t *s)
+{
     int size;
-    char byte;
-    bool no_frame;
-    bool transpose;
-    byte = 0x00;
-    /* First of all read the two first bytes */
-    while((unsigned char)byte != FEND){
-        size = read(fd, &byte, 1);
-        if (size <= 0){
-            if (size == 0){
-                printf("End of socket\n");
-            }else{
-                perror("Error reading socket -> ");
-            }
-            exit(-1);
-        }
+
+    if (s->head > 0) {
+        memmove(s->buf, s->buf + s->head, s->tail - s->head);
+        s->tail -= s->head;
+        s->head = 0;
     }
-    if ((unsigned char)byte == FEND){
-        size = read(fd, &byte, 1);
-        if (size <= 0){
-            if (size == 0){
-                printf("End of socket\n");
-            }else{
-                perror("Error reading socket -> ");
-            }
-            exit(-1);
-        }
-        if ((unsigned char)byte != 0x00){
-            printf("Control frame found: ");
-            no_frame = true;
-            i = 0;
-            transpose = false;
-            while(no_frame){
-                size = read(fd, &byte, 1);
-                if (size <= 0){
-                    if (size == 0){
-                        printf("End of socket\n");
-                    }else{
-                        perror("Error reading socket -> ");
-                    }
-                    exit(-1);
-                }
-                if ((unsigned char)byte == FEND){
-                    no_frame = false;
-                }else if (transpose == true){
-                    if ((unsigned char) byte == TFEND){
-                        buffer[i] = FEND;
-                    }else if ((unsigned char) byte == TFESC){
-                        buffer[i] = FESC;
-                    }
-                    transpose = false;
-                    i++;
-                }else if ((unsigned char) byte == FESC){
-                    transpose = true;
-                }else{
-                    buffer[i] = byte;
-                    i++;
-                }
-            }
-            buffer[i] = '\0';
-            printf("%s\n", buffer);
-            return -2;
+    if (s->tail == AIS_STREAM_CHUNK) {
+        /* a single frame fills the whole buffer, it can never complete */
+        printf("Frame longer than %d bytes dropped\n", AIS_STREAM_CHUNK);
+        s->tail = 0;
+    }
+
+    size = read(s->fd, s->buf + s->tail, AIS_STREAM_CHUNK - s->tail);
+    if (size < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        return -1;      /* non-blocking socket with nothing queued, errno tells */
+    if (size <= 0){
+        if (size == 0){
+            printf("End of socket\n");
+        }else{
+            perror("Error reading socket -> ");
         }
-    }else{
-        return -1;
+        return size;
+    }
+    s->tail += size;
+    return size;
+}
+
+/*
+ *  KISS frame between two FEND, FESC TFEND/TFESC are transposed back.
+ *  Returns the frame length, 0 if no complete frame is buffered, -2 for a dropped frame.
+ */
+static int kiss_next(frame_stream_t *s, uint8_t *frame, int max_len)
+{
+    int i, start, end;
+    int out_size;
+    bool transpose;
+
+    /* skip to the opening FEND */
+    for (start = s->head; start < s->tail && s->buf[start] != FEND; start++)
+        ;
+    s->head = start;
+    if (start == s->tail)
+        return 0;
+    for (end = start + 1; end < s->tail && s->buf[end] != FEND; end++)
+        ;
+    if (end == s->tail)
+        return 0;
+
+    /* the closing FEND may open the next frame */
+    s->head = end;
+    if (end == start + 1)
+        return -2;
+    if (s->buf[start + 1] != 0x00) {
+        printf("Control frame found: command 0x%02x\n", s->buf[start + 1]);
+        return -2;
     }
-    no_frame = true;
-    i = 0;
+
+    out_size = 0;
     transpose = false;
-    while(no_frame){
-        size = read(fd, &byte, 1);
-        if (size <= 0){
-            if (size == 0){
-                printf("End of socket\n");
-            }else{
-                perror("Error reading socket -> ");
-            }
-            exit(-1);
-        }
-        if ((unsigned char)byte == FEND){
-            no_frame = false;
-        }else if (transpose == true){
-            if ((unsigned char) byte == TFEND){
-                buffer[i] = FEND;
-            }else if ((unsigned char) byte == TFESC){
-                buffer[i] = FESC;
-            }
+    for (i = start + 2; i < end; i++) {
+        uint8_t byte = s->buf[i];
+        if (transpose) {
+            if (byte == TFEND)
+                byte = FEND;
+            else if (byte == TFESC)
+                byte = FESC;
             transpose = false;
-            i++;
-        }else if ((unsigned char) byte == FESC){
+        } else if (byte == FESC) {
             transpose = true;
-        }else{
-            buffer[i] = byte;
-            i++;
+            continue;
         }
+        if (out_size == max_len) {
+            printf("KISS frame longer than %d bytes dropped\n", max_len);
+            return -2;
+        }
+        frame[out_size++] = byte;
     }
-    return i;
+    return out_size;
 }
-#else
 
+/*
+ *  PDU preceded by its length, 16 bits big-endian.
+ */
+static int length_next(frame_stream_t *s, uint8_t *frame, int max_len)
+{
+    int len;
 
+    if (s->tail - s->head < 2)
+        return 0;
+    len = (s->buf[s->head] << 8) | s->buf[s->head + 1];
+    if (len + 2 > AIS_STREAM_CHUNK) {
+        /* the prefix can not be trusted anymore, drop what is buffered */
+        printf("PDU length %d out of range, stream resynchronized\n", len);
+        s->head = s->tail;
+        return -2;
+    }
+    if (s->tail - s->head < len + 2)
+        return 0;
 
-int read_kiss_from_socket(int fd, char *buffer)
-{   
+    s->head += len + 2;
+    if (len > max_len) {
+        printf("PDU longer than %d bytes dropped\n", max_len);
+        return -2;
+    }
+    memcpy(frame, s->buf + s->head - len, len);
+    return len;
+}
+
+/*
+ *  NMEA sentence per line, fragments are kept in s->nmea until their message completes.
+ */
+static int nmea_next(frame_stream_t *s, uint8_t *frame, int max_len)
+{
+    uint8_t *nl;
+    int start, len;
 
-  fd_set set;
-  struct timeval timeout;
-  int rv;
-  
-  FD_ZERO(&set); // clear the set 
-  FD_SET(fd, &set); /// add our file descriptor to the set 
+    while ((nl = (uint8_t *)memchr(s->buf + s->head, '\n', s->tail - s->head)) != NULL) {
+        start = s->head;
+        s->head = nl - s->buf + 1;
+        len = nl - (s->buf + start);
+        if (len > 0 && s->buf[start + len - 1] == '\r')
+            len--;
+        len = nmea_decode_sentence(&s->nmea, (const char *)s->buf + start, len, frame, max_len);
+        if (len > 0)
+            return len;
+    }
+    return 0;
+}
 
-  timeout.tv_sec = 5;
-  timeout.tv_usec = 0;
 /*
-  rv = select(fd + 1, &set, NULL, NULL, &timeout);
-  if(bitbufferrv == -1)
-    printf("select"); // an error accured 
-  else if(rv == 0){
-    printf("timeout"); // a timeout occured 
-    return -1;
-  }
-  else{
-    int check = read(fd, buffer, 128); // there was data to read 
-   // printf("\n Data received: %s", buffer);
-    return check;
-  }*/
-
-    int check = read(fd, buffer, 128);
-    //printf("\n Data received: %d", check);
-   // buffer[check] = '\0';
-    return check;
+ *  Whole read() as one PDU, as written by the GNU Radio socket PDU block.
+ */
+static int raw_next(frame_stream_t *s, uint8_t *frame, int max_len)
+{
+    int len = s->tail - s->head;
+
+    if (len == 0)
+        return 0;
+    s->head = s->tail;
+    if (len > max_len) {
+        printf("PDU longer than %d bytes dropped (PDUs coalesced by the stream?)\n", max_len);
+        return -2;
+    }
+    memcpy(frame, s->buf + s->tail - len, len);
+    return len;
 }
 
+int frame_stream_next(frame_stream_t *s, uint8_t *frame, int max_len)
+{
+    int len;
 
-#endif
+    do {
+        switch (s->framing) {
+        case AIS_FRAMING_KISS:
+            len = kiss_next(s, frame, max_len);
+            break;
+        case AIS_FRAMING_LENGTH:
+            len = length_next(s, frame, max_len);
+            break;
+        case AIS_FRAMING_NMEA:
+            len = nmea_next(s, frame, max_len);
+            break;
+        default:
+            len = raw_next(s, frame, max_len);
+            break;
+        }
+    } while (len == -2);
+    return len;
+}
+
+int read_frame_from_stream(frame_stream_t *s, uint8_t *frame, int max_len)
+{
+    int len;
+    int size;
+
+    while ((len = frame_stream_next(s, frame, max_len)) == 0) {
+        size = frame_stream_fill(s);
+        if (size <= 0)
+            return size < 0 ? -1 : 0;
+    }
+    return len;
+}
 
 int socket_init(int port){
     int fd;
@@ -27,11 +27,44 @@
 #include <time.h>
 #include <arpa/inet.h>
 
+#include "nmea.h"
+
 
 #define BACKLOG 5 /* El número de conexiones permitidas */
 #define MAXDATASIZE 256
 
-int read_kiss_from_socket(int fd, char * buffer);
+/* framing of the PDUs on the receive socket */
+#define AIS_FRAMING_RAW         0   /* one read() is one PDU (GNU Radio socket PDU block), only safe on datagrams */
+#define AIS_FRAMING_KISS        1   /* FEND delimited, FESC escaped, KISS command byte first */
+#define AIS_FRAMING_LENGTH      2   /* every PDU preceded by its length, 16 bits big-endian */
+#define AIS_FRAMING_NMEA        3   /* NMEA 0183 !AIVDM/!AIVDO lines, multi-sentence messages reassembled */
+
+#ifndef AIS_STREAM_FRAMING
+#define AIS_STREAM_FRAMING      AIS_FRAMING_RAW
+#endif
+
+#define AIS_STREAM_CHUNK        8192
+
+/*
+ *  Buffered reader splitting a socket byte stream into frames. Each read() takes as much
+ *  as the kernel has queued, so a burst of frames costs a single syscall; frames split over
+ *  several reads are kept until they complete.
+ */
+typedef struct frame_stream_s{
+    int         fd;
+    int         framing;
+    int         head;               /* first unparsed byte of buf */
+    int         tail;               /* end of the bytes read so far */
+    uint8_t     buf[AIS_STREAM_CHUNK];
+    nmea_reassembly_t nmea;         /* AIS_FRAMING_NMEA only */
+}frame_stream_t;
+
+void frame_stream_init(frame_stream_t *s, int fd, int framing);
+int frame_stream_fill(frame_stream_t *s);
+/* next complete frame already buffered: its length, or 0 if none (no read) */
+int frame_stream_next(frame_stream_t *s, uint8_t *frame, int max_len);
+/* next frame, reading the socket as needed: its length, 0 at the end of the socket, -1 on error */
+int read_frame_from_stream(frame_stream_t *s, uint8_t *frame, int max_len);
 int socket_init(int port);
 
 #endif /* defined(___CAT_2_COMMS_SOCKET__socket_utils__) */
@@ -0,0 +1,608 @@
+/*
+  benchmark.cpp
+  @Description: Microbenchmarks for the filter, hashing and HMAC hot paths of the AIS_CAESAR Protocol PoC
+
+  Every benchmark is warmed up, then timed over a number of samples of a batch of operations.
+  Results are summarized per operation (min, median, mean, p99, stddev in nanoseconds) and
+  written as CSV (default) or JSON lines (--json) on stdout.
+
+  Compile command:
+  g++ -O2 benchmark.cpp BloomFilter.cpp XorFilter.cpp MurmurHash3Stream.cpp ais_receiver/socket_utils.c ais_receiver/nmea.c ais_receiver/ais_columns.c smhasher-master/src/MurmurHash3.cpp core-master/cpp/core.a -lpthread -o benchmark
+
+  Usage: ./benchmark [--json] [--samples N] [--warmup N]
+**/
+
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <string.h>
+#include "BloomFilter.h"
+#include "XorFilter.h"
+#include "ais_receiver/socket_utils.h"
+#include "core-master/cpp/core.h"
+#include "ais_receiver/ais_columns.h"
+#include "SpscQueue.h"
+#include <thread>
+#include <memory>
+
+using namespace core;
+
+#define BENCH_SAMPLES 200
+#define BENCH_WARMUP 20
+#define BENCH_QUERIES 100000
+#define AIS_MESSAGE_BITS 168
+#define MAX_SLOT_PAYLOAD_BYTES 66
+
+struct BenchResult {
+  std::string name;
+  std::size_t param;      //operation specific size (keys, bits or bytes)
+  std::size_t batch;      //operations per sample
+  double min, median, mean, p99, stddev;
+  double fp;              //measured false-positive rate, filters only
+};
+
+static int samples = BENCH_SAMPLES;
+static int warmup = BENCH_WARMUP;
+static bool json = false;
+
+//results are accumulated here so the optimizer keeps the measured work
+static volatile uint64_t sink;
+
+/**
+ *  @brief Generate n distinct AIS-like messages as '0'/'1' strings
+ *  @param std::size_t n number of messages
+ *  @param uint64_t offset first message id, to keep sets disjoint
+ *  @return vector of messages
+ */
+std::vector<std::string> generate_messages(std::size_t n, uint64_t offset){
+  std::vector<std::string> messages;
+  messages.reserve(n);
+  for (std::size_t i = 0; i < n; i++) {
+    std::string message(AIS_MESSAGE_BITS, '0');
+    uint64_t id = offset + i;
+    for (int b = 0; b < 64; b++)
+      message[AIS_MESSAGE_BITS - 1 - b] = ((id >> b) & 1) ? '1' : '0';
+    messages.push_back(message);
+  }
+  return messages;
+}
+
+/**
+ *  @brief Pack '0'/'1' strings into 21 byte frames, as sent on air
+ *  @param std::vector<std::string> &messages
+ *  @return vector of packed frames
+ */
+std::vector<std::string> pack_messages(const std::vector<std::string> &messages){
+  std::vector<std::string> packed;
+  packed.reserve(messages.size());
+  for (auto &m : messages) {
+    std::string out((m.length() + 7) / 8, '\0');
+    for (std::size_t i = 0; i < m.length(); i++) {
+      if (m[i] == '1')
+        out[i / 8] |= 1 << (7 - i % 8);
+    }
+    packed.push_back(out);
+  }
+  return packed;
+}
+
+/**
+ *  @brief Time op(i) for i in [0, batch) per sample, after warmup
+ *  @param const char *name benchmark name
+ *  @param std::size_t param operation specific size reported with the result
+ *  @param std::size_t batch number of operations per sample
+ *  @param F op operation under test
+ *  @return summary in nanoseconds per operation
+ */
+template <class F>
+BenchResult run_bench(const char *name, std::size_t param, std::size_t batch, F op){
+  for (int w = 0; w < warmup; w++)
+    for (std::size_t i = 0; i < batch; i++)
+      op(i);
+
+  std::vector<double> ns(samples);
+  for (int s = 0; s < samples; s++) {
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < batch; i++)
+      op(i);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    ns[s] = std::chrono::duration<double, std::nano>(elapsed).count() / batch;
+  }
+
+  std::sort(ns.begin(), ns.end());
+  BenchResult r;
+  r.name = name;
+  r.param = param;
+  r.batch = batch;
+  r.min = ns.front();
+  r.median = ns[ns.size() / 2];
+  r.p99 = ns[std::min(ns.size() - 1, (std::size_t)ceil(0.99 * ns.size()) - 1)];
+  r.mean = 0;
+  for (double v : ns)
+    r.mean += v;
+  r.mean /= ns.size();
+  r.stddev = 0;
+  for (double v : ns)
+    r.stddev += (v - r.mean) * (v - r.mean);
+  r.stddev = sqrt(r.stddev / ns.size());
+  r.fp = -1;
+  return r;
+}
+
+void print_header(){
+  if (!json)
+    printf("name,param,batch,samples,min_ns,median_ns,mean_ns,p99_ns,stddev_ns,fp_rate\n");
+}
+
+void print_result(const BenchResult &r){
+  if (json) {
+    printf("{\"name\":\"%s\",\"param\":%zu,\"batch\":%zu,\"samples\":%d,\"min_ns\":%.2f,\"median_ns\":%.2f,"
+           "\"mean_ns\":%.2f,\"p99_ns\":%.2f,\"stddev_ns\":%.2f",
+           r.name.c_str(), r.param, r.batch, samples, r.min, r.median, r.mean, r.p99, r.stddev);
+    if (r.fp >= 0)
+      printf(",\"fp_rate\":%.6f", r.fp);
+    printf("}\n");
+  } else {
+    printf("%s,%zu,%zu,%d,%.2f,%.2f,%.2f,%.2f,%.2f,", r.name.c_str(), r.param, r.batch, samples,
+           r.min, r.median, r.mean, r.p99, r.stddev);
+    if (r.fp >= 0)
+      printf("%.6f", r.fp);
+    printf("\n");
+  }
+  fflush(stdout);
+}
+
+/**
+ *  @brief MurmurHash3_x64_128 on packed frames and on '0'/'1' strings
+ */
+void bench_hash(){
+  auto messages = generate_messages(1024, 0);
+  auto packed = pack_messages(messages);
+  uint64_t out[2];
+
+  print_result(run_bench("murmur3_x64_128_packed", packed[0].length(), 1024, [&](std::size_t i){
+    MurmurHash3_x64_128(packed[i].data(), packed[i].length(), 0, out);
+    sink += out[0];
+  }));
+  print_result(run_bench("murmur3_x64_128_ascii", messages[0].length(), 1024, [&](std::size_t i){
+    MurmurHash3_x64_128(messages[i].data(), messages[i].length(), 0, out);
+    sink += out[0];
+  }));
+}
+
+/**
+ *  @brief Digest of a payload received in fragments: concatenate then hash, or stream the fragments
+ *  @param std::size_t payload_bytes payload size, split over 3 type 8 slots
+ *  @return false if the streamed digest differs from the one-shot digest
+ */
+bool bench_hash_fragments(std::size_t payload_bytes){
+  std::vector<std::string> fragments;
+  for (std::size_t i = 0, len = (payload_bytes + 2) / 3; i < payload_bytes; i += len)
+    fragments.push_back(std::string(std::min(len, payload_bytes - i), (char)(i + 1)));
+
+  std::string payload;
+  for (auto &f : fragments)
+    payload += f;
+  Murmur3Hash::Stream stream;
+  for (std::size_t cut = 0; cut <= payload.length(); cut++) {
+    stream.reset();
+    stream.process(payload.data(), cut);
+    stream.process(payload.data() + cut, payload.length() - cut);
+    if (stream.result() != Murmur3Hash::hash((const uint8_t *)payload.data(), payload.length())) {
+      fprintf(stderr, "Error: streamed digest differs from MurmurHash3_x64_128 for cut %zu\n", cut);
+      return false;
+    }
+  }
+
+  print_result(run_bench("murmur3_fragments_concat", payload_bytes, 1024, [&](std::size_t){
+    std::string joined;
+    for (auto &f : fragments)
+      joined += f;
+    sink += Murmur3Hash::hash((const uint8_t *)joined.data(), joined.length())[0];
+  }));
+  print_result(run_bench("murmur3_fragments_stream", payload_bytes, 1024, [&](std::size_t){
+    Murmur3Hash::Stream s;
+    for (auto &f : fragments)
+      s.process(f.data(), f.length());
+    sink += s.result()[0];
+  }));
+  return true;
+}
+
+/**
+ *  @brief add/possiblyContains/get_string/to_bits of BloomFilter and StaticBloomFilter,
+ *  with the level 5 parameters (520 bits, k=4)
+ */
+void bench_bloom(){
+  const std::size_t bits = 520;
+  const uint8_t k = 4;
+  auto packed = pack_messages(generate_messages(1024, 0));
+
+  BloomFilter bloomf(bits, k);
+  StaticBloomFilter<bits, k> sbloomf;
+
+  print_result(run_bench("bloom_add", bits, 1024, [&](std::size_t i){
+    bloomf.add((const uint8_t *)packed[i].data(), packed[i].length());
+  }));
+  print_result(run_bench("bloom_possiblyContains", bits, 1024, [&](std::size_t i){
+    sink += bloomf.possiblyContains((const uint8_t *)packed[i].data(), packed[i].length());
+  }));
+  print_result(run_bench("static_bloom_add", bits, 1024, [&](std::size_t i){
+    sbloomf.add((const uint8_t *)packed[i].data(), packed[i].length());
+  }));
+  print_result(run_bench("static_bloom_possiblyContains", bits, 1024, [&](std::size_t i){
+    sink += sbloomf.possiblyContains((const uint8_t *)packed[i].data(), packed[i].length());
+  }));
+
+  std::string bf = bloomf.get_string();
+  print_result(run_bench("bloom_get_string", bits, 16, [&](std::size_t){
+    sink += bloomf.get_string().length();
+  }));
+  print_result(run_bench("bloom_to_bits", bits, 16, [&](std::size_t){
+    bloomf.to_bits(bf);
+  }));
+  print_result(run_bench("static_bloom_get_string", bits, 16, [&](std::size_t){
+    sink += sbloomf.get_string().length();
+  }));
+  print_result(run_bench("static_bloom_to_bits", bits, 16, [&](std::size_t){
+    sbloomf.to_bits(bf);
+  }));
+}
+
+/**
+ *  @brief Union/intersection/cardinality estimate of two receivers' B.F. summaries
+ *  @param std::size_t bits B.F. size
+ */
+void bench_bloom_algebra(std::size_t bits){
+  const uint8_t k = 7;
+  auto packed = pack_messages(generate_messages(bits / 16, 0));
+
+  //each receiver heard two thirds of the messages, overlapping on the middle third
+  BloomFilter a(bits, k), b(bits, k);
+  for (std::size_t i = 0; i < packed.size(); i++) {
+    if (i < 2 * packed.size() / 3)
+      a.add((const uint8_t *)packed[i].data(), packed[i].length());
+    if (i >= packed.size() / 3)
+      b.add((const uint8_t *)packed[i].data(), packed[i].length());
+  }
+
+  print_result(run_bench("bloom_unite", bits, 64, [&](std::size_t){
+    BloomFilter u = a;
+    u.unite(b);
+    sink += u.popcount();
+  }));
+  print_result(run_bench("bloom_intersect", bits, 64, [&](std::size_t){
+    BloomFilter x = a;
+    x.intersect(b);
+    sink += x.popcount();
+  }));
+  print_result(run_bench("bloom_estimateCardinality", bits, 64, [&](std::size_t){
+    sink += (uint64_t)a.estimateCardinality();
+  }));
+}
+
+/**
+ *  @brief Build and query BloomFilter against XorFilter for n messages with the same bit budget
+ *  @param std::size_t n number of messages in the epoch
+ */
+void bench_filters(std::size_t n){
+  auto members = pack_messages(generate_messages(n, 0));
+  auto others = pack_messages(generate_messages(BENCH_QUERIES, n));
+
+  std::size_t bits = XorFilter(n).size_bits();
+  int k = std::max(1, (int)round(log(2) * bits / n));
+
+  BenchResult r = run_bench("bloom_build_per_key", n, 1, [&](std::size_t){
+    BloomFilter bloomf(bits, k);
+    for (auto &m : members)
+      bloomf.add((const uint8_t *)m.data(), m.length());
+    sink += bloomf.possiblyContains((const uint8_t *)members[0].data(), members[0].length());
+  });
+  r.min /= n; r.median /= n; r.mean /= n; r.p99 /= n; r.stddev /= n;
+  print_result(r);
+
+  r = run_bench("xor_build_per_key", n, 1, [&](std::size_t){
+    XorFilter xorf(n);
+    for (auto &m : members)
+      xorf.add((const uint8_t *)m.data(), m.length());
+    sink += xorf.build();
+  });
+  r.min /= n; r.median /= n; r.mean /= n; r.p99 /= n; r.stddev /= n;
+  print_result(r);
+
+  BloomFilter bloomf(bits, k);
+  XorFilter xorf(n);
+  for (auto &m : members) {
+    bloomf.add((const uint8_t *)m.data(), m.length());
+    xorf.add((const uint8_t *)m.data(), m.length());
+  }
+  xorf.build();
+
+  std::size_t fp = 0;
+  for (auto &m : others)
+    fp += bloomf.possiblyContains((const uint8_t *)m.data(), m.length());
+  r = run_bench("bloom_query", n, 1024, [&](std::size_t i){
+    sink += bloomf.possiblyContains((const uint8_t *)others[i].data(), others[i].length());
+  });
+  r.fp = (double)fp / others.size();
+  print_result(r);
+
+  fp = 0;
+  for (auto &m : others)
+    fp += xorf.possiblyContains((const uint8_t *)m.data(), m.length());
+  r = run_bench("xor_query", n, 1024, [&](std::size_t i){
+    sink += xorf.possiblyContains((const uint8_t *)others[i].data(), others[i].length());
+  });
+  r.fp = (double)fp / others.size();
+  print_result(r);
+}
+
+/**
+ *  @brief HMAC-SHA512 truncated to 20 bytes over the packed frames of an epoch
+ *  @param int number_of_messages frames covered by the tag
+ */
+void bench_hmac(int number_of_messages){
+  auto packed = pack_messages(generate_messages(number_of_messages, 0));
+
+  char k[16], m[64 * 32], t[64];
+  octet K = {0, sizeof(k), k};
+  octet M = {0, sizeof(m), m};
+  octet T = {0, sizeof(t), t};
+  OCT_fromHex(&K, (char *) "3befe8479939cbb8772d4fd0985a2502");
+  for (auto &p : packed)
+    OCT_jbytes(&M, (char *)p.data(), p.length());
+
+  print_result(run_bench("hmac_sha512_20", M.len, 64, [&](std::size_t){
+    HMAC(MC_SHA2, SHA512, &T, 20, &K, &M);
+    sink += T.val[0];
+  }));
+}
+
+/**
+ *  @brief Burst of frames through a socket pair: one read() per frame, as the receiver did,
+ *  or KISS framed and split by the buffered frame_stream_t
+ *  @param int frames frames per burst
+ */
+void bench_framer(int frames){
+  auto packed = pack_messages(generate_messages(frames, 0));
+  std::string raw, kiss;
+  for (auto &p : packed) {
+    raw += p;
+    kiss += "\xc0";
+    kiss += '\0';
+    for (char c : p) {
+      if ((uint8_t)c == 0xc0)
+        kiss += "\xdb\xdc";
+      else if ((uint8_t)c == 0xdb)
+        kiss += "\xdb\xdd";
+      else
+        kiss += c;
+    }
+    kiss += "\xc0";
+  }
+
+  int sv[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) {
+    perror("socketpair");
+    return;
+  }
+  uint8_t frame[256];
+  frame_stream_t stream;
+  frame_stream_init(&stream, sv[1], AIS_FRAMING_KISS);
+
+  print_result(run_bench("socket_read_per_frame", frames, 64, [&](std::size_t){
+    sink += write(sv[0], raw.data(), raw.length());
+    for (auto &p : packed)
+      sink += read(sv[1], frame, p.length());
+  }));
+  print_result(run_bench("kiss_stream_batched", frames, 64, [&](std::size_t){
+    sink += write(sv[0], kiss.data(), kiss.length());
+    for (int i = 0; i < frames; i++)
+      sink += read_frame_from_stream(&stream, frame, sizeof(frame));
+  }));
+  close(sv[0]);
+  close(sv[1]);
+}
+
+/**
+ *  @brief NMEA sentences of a packed frame, split in fragments of at most 60 armor characters
+ *  @param const std::string &frame
+ *  @param int seqid sequential message id, used if more than one sentence
+ *  @return sentences without line terminator
+ */
+std::vector<std::string> nmea_sentences(const std::string &frame, int seqid){
+  std::string armor;
+  int bits = frame.length() * 8;
+  for (int pos = 0; pos < bits; pos += 6) {
+    int v = 0;
+    for (int b = pos; b < pos + 6; b++)
+      v = (v << 1) | (b < bits ? ((uint8_t)frame[b / 8] >> (7 - b % 8)) & 1 : 0);
+    armor += (char)(v < 40 ? v + 48 : v + 56);
+  }
+  int fill = (6 - bits % 6) % 6;
+
+  std::vector<std::string> sentences;
+  int parts = (armor.length() + 59) / 60;
+  for (int n = 0; n < parts; n++) {
+    char body[128], sentence[136];
+    snprintf(body, sizeof(body), "AIVDM,%d,%d,%s,A,%s,%d", parts, n + 1, parts > 1 ? std::to_string(seqid).c_str() : "",
+             armor.substr(n * 60, 60).c_str(), n == parts - 1 ? fill : 0);
+    uint8_t chk = 0;
+    for (char *c = body; *c; c++)
+      chk ^= *c;
+    snprintf(sentence, sizeof(sentence), "!%s*%02X", body, chk);
+    sentences.push_back(sentence);
+  }
+  return sentences;
+}
+
+/**
+ *  @brief NMEA AIVDM encoding and decoding: type 4 sized frames in one sentence, 3 slot type 8 frames in two
+ *  @return false if an encoded sentence or a decoded frame differs from the reference
+ */
+bool bench_nmea(){
+  std::vector<std::string> frames = pack_messages(generate_messages(512, 0));
+  for (int i = 0; i < 512; i++) {
+    std::string long_frame(8 + MAX_SLOT_PAYLOAD_BYTES, (char)i);
+    long_frame[0] = 8 << 2;
+    frames.push_back(long_frame);
+  }
+  std::vector<std::string> single, multi;
+  for (std::size_t i = 0; i < frames.size(); i++) {
+    for (auto &s : nmea_sentences(frames[i], i % 10))
+      (i < 512 ? single : multi).push_back(s);
+  }
+
+  nmea_reassembly_t r;
+  nmea_reassembly_init(&r);
+  uint8_t frame[NMEA_MAX_MESSAGE_BYTES];
+  std::size_t next = 0;
+  for (auto *sentences : {&single, &multi}) {
+    for (auto &s : *sentences) {
+      int len = nmea_decode_sentence(&r, s.data(), s.length(), frame, sizeof(frame));
+      if (len == 0)
+        continue;
+      if (len != (int)frames[next].length() || memcmp(frame, frames[next].data(), len) != 0) {
+        fprintf(stderr, "Error: NMEA decoding of frame %zu differs from the original\n", next);
+        return false;
+      }
+      next++;
+    }
+  }
+
+  //armoring: reference sentences above vs the table-driven encoder, then the round trip
+  char out[NMEA_MAX_MESSAGE_BYTES * 2];
+  for (std::size_t i = 0; i < frames.size(); i++) {
+    std::string expected;
+    for (auto &s : nmea_sentences(frames[i], i % 10))
+      expected += s + "\r\n";
+    int len = nmea_encode((const uint8_t *)frames[i].data(), frames[i].length() * 8, i % 10, 'A', out, sizeof(out));
+    if (len != (int)expected.length() || memcmp(out, expected.data(), len) != 0) {
+      fprintf(stderr, "Error: nmea_encode of frame %zu differs from the reference sentences\n", i);
+      return false;
+    }
+  }
+
+  print_result(run_bench("nmea_armor_reference", frames[0].length(), 512, [&](std::size_t i){
+    sink += nmea_sentences(frames[i], 0)[0].length();
+  }));
+  print_result(run_bench("nmea_encode", frames[0].length(), 512, [&](std::size_t i){
+    sink += nmea_encode((const uint8_t *)frames[i].data(), frames[i].length() * 8, 0, 'A', out, sizeof(out));
+  }));
+  print_result(run_bench("nmea_encode_fragments", frames[512].length(), 512, [&](std::size_t i){
+    sink += nmea_encode((const uint8_t *)frames[512 + i].data(), frames[512 + i].length() * 8, i % 10, 'A', out, sizeof(out));
+  }));
+  print_result(run_bench("nmea_decode_single", single[0].length(), single.size(), [&](std::size_t i){
+    sink += nmea_decode_sentence(&r, single[i].data(), single[i].length(), frame, sizeof(frame));
+  }));
+  print_result(run_bench("nmea_decode_fragments", multi[0].length(), multi.size(), [&](std::size_t i){
+    sink += nmea_decode_sentence(&r, multi[i].data(), multi[i].length(), frame, sizeof(frame));
+  }));
+  return true;
+}
+
+/**
+ *  @brief Columnar decode of a mixed batch (class A/B positions, base stations, static data, CAESAR type 8)
+ *  @param int records batch size, decoded in chunks of 64 records
+ *  @return void
+ */
+void bench_columns(int records){
+  static const int types[] = {1, 3, 18, 1, 4, 5, 24, 8, 1, 19, 2, 18, 1, 24, 8, 1};
+  std::vector<ais_message_t> msgs(records);
+  for (int i = 0; i < records; i++) {
+    ais_message_t &m = msgs[i];
+    std::string bits(AisType5::bits, '0');
+    memset(&m, 0, sizeof(m));
+    m.type = types[i % 16];
+    AisHeader::type::put(bits, m.type);
+    AisHeader::mmsi::put(bits, 200000000 + i);
+    if (m.type <= 3) {
+      AisType1::lat::put_value(bits, 41.38 + i * 1e-4);
+      AisType1::lon::put_value(bits, 2.17 - i * 1e-4);
+      AisType1::sog::put_value(bits, 12.5);
+      AisType1::second::put(bits, i % 60);
+    } else if (m.type == 4) {
+      AisType4::year::put(bits, 2019);
+      AisType4::month::put(bits, 2);
+      AisType4::day::put(bits, 25);
+    } else if (m.type == 8) {
+      AisType8::security_level::put(bits, 5);
+      m.security_level = 5;
+      m.payload_offset = AisType8::caesar_payload;
+      m.payload_bits = AIS_MESSAGE_BITS - AisType8::caesar_payload;
+    }
+    std::string frame = pack_messages({bits})[0];
+    memcpy(m.frame, frame.data(), frame.length());
+    m.byte_cnt = frame.length();
+    m.bit_cnt = bits.length();
+    m.src_mmsi = 200000000 + i;
+  }
+
+  AisColumns cols;
+  print_result(run_bench("ais_decode_columns", 64, records / 64, [&](std::size_t i){
+    if (i == 0)
+      cols.clear();
+    ais_decode_columns(msgs.data() + 64 * i, 64, &cols);
+    sink += cols.size();
+  }));
+}
+
+/**
+ *  @brief Receiver pipeline queue: frame sized items pushed here, popped by a second thread
+ *  @return void
+ */
+void bench_queue(){
+  struct Item { uint8_t frame[256]; uint16_t len; };
+  typedef SpscQueue<Item, 1024> Queue;
+  const std::size_t batch = 4096;
+  std::unique_ptr<Queue> queue(new Queue());
+  std::size_t total = (warmup + samples) * batch;
+  std::thread consumer([&]{
+    Item item;
+    for (std::size_t i = 0; i < total; i++) {
+      queue->pop(item);
+      sink += item.len;
+    }
+  });
+  Item item = {};
+  print_result(run_bench("spsc_queue_push", sizeof(Item), batch, [&](std::size_t i){
+    item.len = i;
+    queue->push(item);
+  }));
+  consumer.join();
+}
+
+int main(int argc, char **argv)
+{
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--json") == 0)
+      json = true;
+    else if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc)
+      samples = std::max(1, atoi(argv[++i]));
+    else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc)
+      warmup = std::max(0, atoi(argv[++i]));
+    else {
+      fprintf(stderr, "Usage: %s [--json] [--samples N] [--warmup N]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  print_header();
+  bench_hash();
+  if (!bench_hash_fragments(3 * MAX_SLOT_PAYLOAD_BYTES))
+    return 1;
+  bench_bloom();
+  bench_bloom_algebra(520);
+  bench_bloom_algebra(1 << 20);
+  std::size_t sizes[] = {2, 4, 9, 100, 1000, 10000};
+  for (std::size_t n : sizes)
+    bench_filters(n);
+  bench_hmac(9);
+  bench_framer(9);
+  bench_framer(64);
+  if (!bench_nmea())
+    return 1;
+  bench_columns(1024);
+  bench_queue();
+  return 0;
+}
@@ -0,0 +1,266 @@
+/*
+  fp_sim.cpp
+  @Description: Monte Carlo simulation of the B.F./xor filter false-positive rate of the AIS_CAESAR Protocol PoC
+
+  For every security level with a filter, each simulated epoch hashes N random packed frames into
+  the filter and then checks F forged frames against it. For Bloom filter levels the epoch is
+  repeated for every k in [1, kmax] on the same frames, so the k used on the wire can be compared
+  with the k that minimizes the measured rate. Epochs are split over worker threads, each with its
+  own random stream.
+
+  Reported per level:
+    fp       - fraction of forged frames accepted by the filter
+    forgery  - fraction of epochs in which at least one of the F forged frames was accepted
+    theory   - (1 - e^(-kN/z))^k for the same z and k
+
+  Compile command:
+  g++ -O2 fp_sim.cpp BloomFilter.cpp XorFilter.cpp smhasher-master/src/MurmurHash3.cpp -lpthread -o fp_sim
+
+  Usage: ./fp_sim [--csv] [--epochs N] [--forged F] [--kmax K] [--threads T] [--seed S]
+**/
+
+#include <cmath>
+#include <thread>
+#include <string.h>
+#include <random>
+#include <algorithm>
+#include "CaesarLevel.h"
+
+#define SIM_EPOCHS 100000
+#define SIM_FORGED 16
+#define SIM_KMAX 32
+#define AIS_MESSAGE_BYTES 21
+
+struct SimLevel {
+  int level;
+  int number_of_messages;
+  int filter_bits;
+  int num_hashes;     //k used on the wire, 0 for the xor filter
+  bool xor_filter;
+};
+
+struct SimCounts {
+  std::vector<uint64_t> accepted;         //forged frames accepted, per k (index 0 = xor filter)
+  std::vector<uint64_t> forged_epochs;    //epochs with at least one accepted forged frame, per k
+};
+
+static uint64_t epochs = SIM_EPOCHS;
+static int forged = SIM_FORGED;
+static int kmax = SIM_KMAX;
+static unsigned threads = 0;
+static uint64_t seed = 1;
+static bool csv = false;
+
+/**
+ *  @brief Wire parameters of a security level, as compiled into main/recvr
+ *  @return SimLevel
+ */
+template <int Level>
+SimLevel sim_level(){
+  typedef CaesarLevel<Level> L;
+  SimLevel s;
+  s.level = Level;
+  s.number_of_messages = L::number_of_messages;
+  s.filter_bits = L::filter_bits;
+  s.num_hashes = L::num_hashes;
+  s.xor_filter = false;
+  return s;
+}
+
+template <>
+SimLevel sim_level<7>(){
+  typedef CaesarLevel<7> L;
+  SimLevel s;
+  s.level = 7;
+  s.number_of_messages = L::number_of_messages;
+  s.filter_bits = L::make_filter().size_bits();
+  s.num_hashes = 0;
+  s.xor_filter = true;
+  return s;
+}
+
+/**
+ *  @brief Digest of a random packed AIS frame
+ *  @param std::mt19937_64 &rng
+ *  @return CaesarHash digest of the frame
+ */
+std::array<uint64_t, 2> random_frame_digest(std::mt19937_64 &rng){
+  uint8_t frame[AIS_MESSAGE_BYTES];
+  for (int i = 0; i < AIS_MESSAGE_BYTES; i += 8) {
+    uint64_t r = rng();
+    memcpy(frame + i, &r, std::min(8, AIS_MESSAGE_BYTES - i));
+  }
+  return ::hash(frame, sizeof(frame));
+}
+
+/**
+ *  @brief Run a share of the epochs of a level
+ *  @param const SimLevel &s level under test
+ *  @param uint64_t n number of epochs
+ *  @param uint64_t thread_seed seed of this worker's random stream
+ *  @param SimCounts &counts output, sized kmax + 1
+ */
+void simulate(const SimLevel &s, uint64_t n, uint64_t thread_seed, SimCounts &counts){
+  std::mt19937_64 rng(thread_seed);
+  std::vector<std::array<uint64_t, 2>> members(s.number_of_messages);
+  std::vector<std::array<uint64_t, 2>> forgeries(forged);
+
+  for (uint64_t e = 0; e < n; e++) {
+    for (auto &d : members)
+      d = random_frame_digest(rng);
+    for (auto &d : forgeries)
+      d = random_frame_digest(rng);
+
+    if (s.xor_filter) {
+      XorFilter xorf(s.number_of_messages);
+      for (auto &d : members)
+        xorf.addHashed(d);
+      xorf.build();
+      uint64_t accepted = 0;
+      for (auto &d : forgeries)
+        accepted += xorf.containsHashed(d);
+      counts.accepted[0] += accepted;
+      counts.forged_epochs[0] += accepted > 0;
+      continue;
+    }
+
+    for (int k = 1; k <= kmax; k++) {
+      BloomFilter bloomf(s.filter_bits, k);
+      for (auto &d : members)
+        bloomf.addHashed(d);
+      uint64_t accepted = 0;
+      for (auto &d : forgeries)
+        accepted += bloomf.containsHashed(d);
+      counts.accepted[k] += accepted;
+      counts.forged_epochs[k] += accepted > 0;
+    }
+  }
+}
+
+/**
+ *  @brief Run all epochs of a level over the worker threads and merge the counts
+ *  @param const SimLevel &s
+ *  @return merged counts
+ */
+SimCounts run_level(const SimLevel &s){
+  std::vector<SimCounts> partial(threads);
+  std::vector<std::thread> workers;
+  for (unsigned t = 0; t < threads; t++) {
+    partial[t].accepted.assign(kmax + 1, 0);
+    partial[t].forged_epochs.assign(kmax + 1, 0);
+    uint64_t share = epochs / threads + (t < epochs % threads ? 1 : 0);
+    uint64_t thread_seed = seed * 1000003 + s.level * 1009 + t;
+    workers.push_back(std::thread(simulate, std::cref(s), share, thread_seed, std::ref(partial[t])));
+  }
+  for (auto &w : workers)
+    w.join();
+
+  SimCounts total;
+  total.accepted.assign(kmax + 1, 0);
+  total.forged_epochs.assign(kmax + 1, 0);
+  for (auto &p : partial) {
+    for (int k = 0; k <= kmax; k++) {
+      total.accepted[k] += p.accepted[k];
+      total.forged_epochs[k] += p.forged_epochs[k];
+    }
+  }
+  return total;
+}
+
+double theory_fp(const SimLevel &s, int k){
+  return pow(1 - exp(-(double)k * s.number_of_messages / s.filter_bits), k);
+}
+
+/**
+ *  @brief Format a measured rate, with the rule-of-three bound when nothing was observed
+ *  @param uint64_t hits
+ *  @param uint64_t trials
+ *  @return printable rate
+ */
+std::string rate(uint64_t hits, uint64_t trials){
+  char buf[32];
+  if (hits == 0)
+    snprintf(buf, sizeof(buf), "<%.2e", 3.0 / trials);
+  else
+    snprintf(buf, sizeof(buf), "%.3e", (double)hits / trials);
+  return buf;
+}
+
+void report(const SimLevel &s, const SimCounts &c){
+  uint64_t trials = epochs * forged;
+
+  if (csv) {
+    if (s.xor_filter) {
+      printf("%d,%d,%d,xor,1,%.6e,,%.6e\n", s.level, s.number_of_messages, s.filter_bits,
+             (double)c.accepted[0] / trials, (double)c.forged_epochs[0] / epochs);
+      return;
+    }
+    for (int k = 1; k <= kmax; k++)
+      printf("%d,%d,%d,%d,%d,%.6e,%.6e,%.6e\n", s.level, s.number_of_messages, s.filter_bits, k,
+             k == s.num_hashes, (double)c.accepted[k] / trials, theory_fp(s, k),
+             (double)c.forged_epochs[k] / epochs);
+    return;
+  }
+
+  printf("Level %d (N=%d, z=%d bits)\n", s.level, s.number_of_messages, s.filter_bits);
+  if (s.xor_filter) {
+    printf("   xor filter:  fp %s  forgery %s\n",
+           rate(c.accepted[0], trials).c_str(), rate(c.forged_epochs[0], epochs).c_str());
+    return;
+  }
+
+  //lowest measured rate, ties go to the smaller k (fewer probes)
+  int best = 1;
+  for (int k = 2; k <= kmax; k++) {
+    if (c.accepted[k] < c.accepted[best])
+      best = k;
+  }
+  printf("   wire    k=%-2d fp %s  forgery %s  theory %.3e\n", s.num_hashes,
+         rate(c.accepted[s.num_hashes], trials).c_str(),
+         rate(c.forged_epochs[s.num_hashes], epochs).c_str(), theory_fp(s, s.num_hashes));
+  printf("   optimal k=%-2d fp %s  forgery %s  theory %.3e\n", best,
+         rate(c.accepted[best], trials).c_str(),
+         rate(c.forged_epochs[best], epochs).c_str(), theory_fp(s, best));
+}
+
+int main(int argc, char **argv)
+{
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--csv") == 0)
+      csv = true;
+    else if (strcmp(argv[i], "--epochs") == 0 && i + 1 < argc)
+      epochs = std::max(1LL, atoll(argv[++i]));
+    else if (strcmp(argv[i], "--forged") == 0 && i + 1 < argc)
+      forged = std::max(1, atoi(argv[++i]));
+    else if (strcmp(argv[i], "--kmax") == 0 && i + 1 < argc)
+      kmax = std::min(255, std::max(1, atoi(argv[++i])));
+    else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+      threads = std::max(1, atoi(argv[++i]));
+    else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+      seed = strtoull(argv[++i], NULL, 10);
+    else {
+      fprintf(stderr, "Usage: %s [--csv] [--epochs N] [--forged F] [--kmax K] [--threads T] [--seed S]\n", argv[0]);
+      return 1;
+    }
+  }
+  if (threads == 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+
+  SimLevel levels[] = {sim_level<3>(), sim_level<4>(), sim_level<5>(), sim_level<6>(), sim_level<7>()};
+
+  if (csv)
+    printf("level,messages,filter_bits,k,wire,fp_rate,fp_theory,forgery_rate\n");
+  else
+    printf("%llu epochs, %d forged frames per epoch, %u threads\n",
+           (unsigned long long)epochs, forged, threads);
+
+  for (auto &s : levels) {
+    //the sweep indexes accepted[] with the wire k
+    if (!s.xor_filter && s.num_hashes > kmax) {
+      printf("Error: wire k=%d of level %d greater than --kmax\n", s.num_hashes, s.level);
+      return 1;
+    }
+    report(s, run_level(s));
+  }
+  return 0;
+}
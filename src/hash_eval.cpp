@@ -0,0 +1,140 @@
+/*
+  hash_eval.cpp
+  @Description: AIS specific run of the smhasher speed and avalanche tests for the B.F. hash policies
+
+  Every hash policy usable by StaticBloomFilter (Murmur3Hash, City128Hash, Spooky128Hash) is
+  wrapped as an smhasher pfHash and evaluated on the key sizes of the AIS_CAESAR filters:
+    - 21 byte keys: packed 168 bit AIS frames (default encoding)
+    - 168 byte keys: '0'/'1' strings of older senders (-DCAESAR_PACKED_ENCODING=0)
+  Reported per policy: smhasher SpeedTest cycles/hash for both key sizes, smhasher AvalancheTest
+  on 168 bit keys (fails above 1% bias) and the false-positive rate of the level 5 B.F. (520 bits,
+  k=4) on structured type 4 frames that differ only in MMSI and position bits.
+  The fastest policy that passes is the candidate for CaesarHash in BloomFilter.h.
+
+  Compile command, the smhasher support library is built with its own CMakeLists.txt:
+  cmake -S smhasher-master/src -B smhasher-master/build && cmake --build smhasher-master/build --target SMHasherSupport
+  g++ -O2 hash_eval.cpp smhasher-master/build/libSMHasherSupport.a -o hash_eval
+
+  Usage: ./hash_eval [--reps N]
+**/
+
+#include <string.h>
+#include "BloomFilter.h"
+#include "HashPolicy.h"
+#include "smhasher-master/src/AvalancheTest.h"
+#include "smhasher-master/src/SpeedTest.h"
+
+#define AVALANCHE_REPS 300000
+#define SPEED_TRIALS 999999
+#define AIS_MESSAGE_BYTES 21
+#define AIS_MESSAGE_BITS 168
+#define FP_EPOCHS 20000
+#define FP_MESSAGES 9
+#define FP_QUERIES 16
+
+//SpeedTest.cpp only exports the printing wrappers
+double SpeedTest ( pfHash hash, uint32_t seed, const int trials, const int blocksize, const int align );
+
+/**
+ *  @brief smhasher view of a hash policy, the seed is ignored as the filters always use 0
+ */
+template <class Hash>
+void policy_hash(const void *key, int len, uint32_t /*seed*/, void *out){
+  std::array<uint64_t, 2> h = Hash::hash((const uint8_t *)key, len);
+  memcpy(out, h.data(), sizeof(h));
+}
+
+/**
+ *  @brief Packed type 4 frame whose MMSI and position fields are derived from id
+ *  @param uint64_t id
+ *  @param uint8_t *frame AIS_MESSAGE_BYTES output
+ */
+void structured_frame(uint64_t id, uint8_t *frame){
+  memset(frame, 0, AIS_MESSAGE_BYTES);
+  frame[0] = 4 << 2;                       //type 4, repeat 0
+  uint32_t mmsi = 247320162 + (id % 1000); //1000 vessels
+  uint32_t lon = 5834147 + (id / 1000);    //slowly moving position
+  for (int b = 0; b < 30; b++) {
+    if ((mmsi >> (29 - b)) & 1)
+      frame[(8 + b) / 8] |= 0x80 >> ((8 + b) % 8);
+  }
+  for (int b = 0; b < 28; b++) {
+    if ((lon >> (27 - b)) & 1)
+      frame[(79 + b) / 8] |= 0x80 >> ((79 + b) % 8);
+  }
+}
+
+/**
+ *  @brief Measured FP rate of the level 5 B.F. on structured frames
+ *  @return fraction of non-member frames accepted
+ */
+template <class Hash>
+double structured_fp(){
+  uint8_t frame[AIS_MESSAGE_BYTES];
+  uint64_t accepted = 0, id = 0;
+  for (int e = 0; e < FP_EPOCHS; e++) {
+    StaticBloomFilter<520, 4, Hash> bloomf;
+    for (int i = 0; i < FP_MESSAGES; i++) {
+      structured_frame(id++, frame);
+      bloomf.add(frame, sizeof(frame));
+    }
+    for (int i = 0; i < FP_QUERIES; i++) {
+      structured_frame(id++, frame);
+      accepted += bloomf.possiblyContains(frame, sizeof(frame));
+    }
+  }
+  return (double)accepted / ((uint64_t)FP_EPOCHS * FP_QUERIES);
+}
+
+/**
+ *  @brief Run the AIS specific tests of a hash policy
+ *  @param const char *name
+ *  @param int reps avalanche repetitions
+ *  @param double &cycles cycles/hash on 21 byte keys, output
+ *  @return true if the avalanche test passed
+ */
+template <class Hash>
+bool evaluate(const char *name, int reps, double &cycles){
+  pfHash h = policy_hash<Hash>;
+
+  printf("[[[ %s ]]]\n", name);
+  cycles = SpeedTest(h, 0, SPEED_TRIALS, AIS_MESSAGE_BYTES, 0);
+  printf("Speed %3d-byte keys (packed frame)  - %8.2f cycles/hash\n", AIS_MESSAGE_BYTES, cycles);
+  printf("Speed %3d-byte keys ('0'/'1' string) - %8.2f cycles/hash\n", AIS_MESSAGE_BITS,
+         SpeedTest(h, 0, SPEED_TRIALS, AIS_MESSAGE_BITS, 0));
+
+  bool result = AvalancheTest<Blob<AIS_MESSAGE_BITS>, uint128_t>(h, reps);
+  printf("B.F. level 5 FP rate on structured type 4 frames - %.3e\n\n", structured_fp<Hash>());
+  return result;
+}
+
+int main(int argc, char **argv)
+{
+  int reps = AVALANCHE_REPS;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc)
+      reps = std::max(10, atoi(argv[++i]));
+    else {
+      fprintf(stderr, "Usage: %s [--reps N]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  const char *names[] = {"Murmur3Hash", "City128Hash", "Spooky128Hash"};
+  double cycles[3];
+  bool passed[3];
+  passed[0] = evaluate<Murmur3Hash>(names[0], reps, cycles[0]);
+  passed[1] = evaluate<City128Hash>(names[1], reps, cycles[1]);
+  passed[2] = evaluate<Spooky128Hash>(names[2], reps, cycles[2]);
+
+  int best = -1;
+  for (int i = 0; i < 3; i++) {
+    if (passed[i] && (best < 0 || cycles[i] < cycles[best]))
+      best = i;
+  }
+  if (best < 0)
+    printf("No hash policy passed the avalanche test\n");
+  else
+    printf("Fastest policy passing on %d-byte keys: %s (%.2f cycles/hash)\n", AIS_MESSAGE_BYTES, names[best], cycles[best]);
+  return 0;
+}
@@ -5,7 +5,7 @@
   @version 1.0 25/02/19
 
   Compile command, add flag -DSECURITY_LEVEL to set another security level, example -DSECURITY_LEVEL=1 
-  g++ -O2 -DSECURITY_LEVEL=1 main.cpp BloomFilter.cpp smhasher-master/src/MurmurHash3.cpp core-master/cpp/core.a ./ais_receiver/*.c -o main
+  g++ -O2 -DSECURITY_LEVEL=1 main.cpp BloomFilter.cpp XorFilter.cpp MurmurHash3Stream.cpp smhasher-master/src/MurmurHash3.cpp core-master/cpp/core.a ./ais_receiver/*.c -o main
 **/
 /*Todo
   Compression support
@@ -58,25 +58,65 @@ string bintohex(const string &s){
     return out;
 }
 
+/**	
+ *  @brief Canonical B.F./HMAC input of a frame given as binary string
+ *  @param string &message '0'/'1' string of the frame
+ *  @return packed frame bytes, or the string itself for ASCII encoding
+ */
+string canonical_message(const string &message){
+    if(!CAESAR_PACKED_ENCODING)
+        return message;
+
+    string out((message.length() + 7) / 8, '\0');
+    pack_bits((uint8_t *)&out[0], message.c_str(), message.length());
+    return out;
+}
+
 /*  Functions used for AIS process itself   */
 
 /**	@brief Create an AIS Message of type 8
  *
  *  @param int src_MMSI
- *  @param string payload
+ *  @param string payload, starting with the CAESAR header (see caesar_header_bits)
  *  @return binary string of message 8
  */
 string encode_ais_message_8(string payload, int src_mmsi=247320162){ 
-    string type = std::bitset<6>(8).to_string(); 
-    string repeat = "00";
-    string mmsi = std::bitset<30>(src_mmsi).to_string();
-    string spare = "00";
-    //application bits, 1 byte metadata are custom bits for self use
-    string application_meta_bits = std::bitset<8>(0).to_string(); 
-    string appid_dac = std::bitset<10>(0).to_string(); 
-    string appid_fi = std::bitset<6>(51).to_string(); 
+    string msg(AisType8::data, '0');
+    AisType8::type::put(msg, 8);
+    AisType8::repeat::put(msg, 0);
+    AisType8::mmsi::put(msg, src_mmsi);
+    AisType8::spare::put(msg, 0);
+    AisType8::dac::put(msg, 0);
+    AisType8::fi::put(msg, 51);
   
-    return type+repeat+mmsi+spare+appid_dac+appid_fi+payload;
+    return msg+payload;
+}
+
+/**	@brief CAESAR header of a type 8 payload, security level and app meta bits
+ *
+ *  @param int security_level
+ *  @param int app_meta CAESAR_APPMETA_* flags
+ *  @return binary string of the first AisType8::caesar_payload - AisType8::data bits of the data field
+ */
+string caesar_header_bits(int security_level, int app_meta){
+    string msg(AisType8::caesar_payload, '0');
+    AisType8::security_level::put(msg, security_level);
+    AisType8::app_meta::put(msg, app_meta);
+
+    return msg.substr(AisType8::data);
+}
+
+/**	@brief CAESAR header of one fragment of a payload split over several messages
+ *
+ *  @param string &header CAESAR header of the whole payload
+ *  @param int following number of fragments sent after this one, 0 for the last (or only) one
+ *  @return header with the fragment bits of the app meta set
+ */
+string caesar_fragment_header(const string &header, int following){
+    string msg = string(AisType8::data, '0') + header;
+    AisType8::fragments::put(msg, following);
+
+    return msg.substr(AisType8::data);
 }
 
 /**	@brief Create an AIS Message of type 4
@@ -86,33 +126,28 @@ string encode_ais_message_8(string payload, int src_mmsi=247320162){
  *  @return binary string of message 4
  */
 string encode_ais_message_4(int src_mmsi=247320162, float speed=0.1, float __long=9.72357833333333, float __lat=45.6910166666667, float __course=83.4, int __ts=38){
-  string _type = std::bitset<6>(4).to_string(); 
-	string _repeat = "00";										// repeat (directive to an AIS transceiver that this message should be rebroadcast.)
-	string _mmsi = std::bitset<30>(src_mmsi).to_string();	// 30 bits (247320162)
-
-  string _hour = std::bitset<5>(24).to_string();
-	string _min = std::bitset<6>(60).to_string();
-  string _sec = std::bitset<6>(60).to_string();
-
-
-	string _accurancy = "1";									// <= 10m
-
-  std::bitset<28> long_complement = std::bitset<28>( std::string("1111111111111111111111111111") );
-  string _long = (std::bitset<28>(round(__long*600000)) & long_complement).to_string();
-
-  std::bitset<27> lat_complement = std::bitset<27>( std::string("111111111111111111111111111") );
-	string _lat =  (std::bitset<27>(round(__lat*600000)) & lat_complement).to_string();
-
-	string _device = "0001";	// GPS
-	string _flags = std::bitset<12>(0).to_string(); 
-	// '0': transmission control for packet 24
-	// '000000000':  spare
-	// '0': Raim flag
-
-	string _rstatus = std::bitset<19>(0).to_string();  // ??
-	// '11100000000000000110' : Radio status
-
-	return _type+_repeat+_mmsi+std::bitset<23>(0).to_string()+_hour+_min+_sec+_accurancy+_long+_lat+_device+std::bitset<11>(0).to_string()+_rstatus;
+  string msg(AisType4::bits, '0');
+  AisType4::type::put(msg, 4);
+  AisType4::repeat::put(msg, 0);            // repeat (directive to an AIS transceiver that this message should be rebroadcast.)
+  AisType4::mmsi::put(msg, src_mmsi);       // 30 bits (247320162)
+
+  AisType4::year::put(msg, 0);              // 0 = N/A
+  AisType4::month::put(msg, 0);
+  AisType4::day::put(msg, 0);
+  AisType4::hour::put(msg, 24);             // 24 = N/A
+  AisType4::minute::put(msg, 60);           // 60 = N/A
+  AisType4::second::put(msg, 60);           // 60 = N/A
+
+  AisType4::accuracy::put(msg, 1);          // <= 10m
+  AisType4::lon::put(msg, round(__long*600000));
+  AisType4::lat::put(msg, round(__lat*600000));
+
+  AisType4::epfd::put(msg, 1);              // GPS
+  AisType4::spare::put(msg, 0);
+  AisType4::raim::put(msg, 0);
+  AisType4::radio::put(msg, 0);             // SOTDMA state
+
+  return msg;
 }
 
 /**	
@@ -145,42 +180,41 @@ int send_ais_message(string *message_sent, string payload, int ais_message_type=
     //check size of payload, fit in 3 slots, max size allowed in 3 slots = 66 bytes according to AIS standard
     int message_count=0;
     int max_payload_size_bytes = MAX_SLOTS_DATA_SIZE;
-    int payload_size_bytes = payload.length()/8;
-    //DEBUG printf("\nSize of payload = %d\n", payload_size_bytes);
 
-    int counter = ceil(payload_size_bytes / (float) max_payload_size_bytes);
-    //DEBUG printf("\nNumber of messages to be send = %d\n", counter);
-    if (ais_message_type==4){
-      counter = 1;
+    //longer payloads are split in fragments, each one repeats the CAESAR header with the number of fragments that follow
+    const int header_bits = AisType8::caesar_payload - AisType8::data;
+    int max_fragment_bits = max_payload_size_bytes*8 - header_bits;
+    string header, body;
+    int counter = 1;
+    if (ais_message_type==8){
+      header = payload.substr(0, header_bits);
+      body = payload.substr(header.length());
+      counter = max(1, (int)ceil(body.length() / (float) max_fragment_bits));
+      //DEBUG printf("\nNumber of messages to be send = %d\n", counter);
+      if (counter > CAESAR_MAX_FRAGMENTS || (AisType8::caesar_payload + body.length() + 7) / 8 > AIS_MAX_FRAME_BYTES){
+        printf("ERROR: CAESAR payload of %zu bits is too long to be reassembled!\n", payload.length());
+        return -1;
+      }
     }
 
-    int start_index = 0, end_index = 0;
     //std::cout<<"Payload length ="<< payload.length()<<endl<<"Payload=\n"<<payload<<endl;
     
     for (int i=0; i<counter; i++){
         string message;
         if (ais_message_type==8){
-          //Send multiple messages, Divide payload into different slot messages if size > 3 continous slots
-          end_index = max_payload_size_bytes*(i+1)*8;
-          if(end_index > payload.length() ){
-              end_index = payload.length();
-          }
-        //DEBUG   std::cout<<"Payload length ="<< payload.length()<<endl<<"Payload=\n"<<payload<<endl;
-        //DEBUG std::cout<<"\nMessage #"<<i<<"Startindex "<< start_index <<" End index"<<end_index <<endl;
-          string payload_2_send = payload.substr(start_index, end_index - start_index );
+          string fragment = body.substr(i*max_fragment_bits, max_fragment_bits);
+          string payload_2_send = (counter > 1 ? caesar_fragment_header(header, counter-1-i) : header) + fragment;
 
           message = encode_ais_message_8(payload_2_send);
          // std::cout<<"\nMessage: "<<payload_2_send;
-
-                //DEBUG   std::cout<<"\nMessage #"<<i<<"Startindex "<< start_index <<" End index"<<end_index<<endl<<message<<"\npayload:"<<payload_2_send<<endl;
-          start_index = end_index; 
         }
         else
         {
            message = encode_ais_message_4();
            if (auth_tag_message!=NULL){
          //    printf("\n message1:  ");//, message.data());
-            OCT_jstring(auth_tag_message, (char *)message.data() );
+            string input = canonical_message(message);
+            OCT_jbytes(auth_tag_message, (char *)input.data(), input.length());
            //  OCT_output(auth_tag_message);
            }
           
@@ -204,78 +238,20 @@ int send_ais_message(string *message_sent, string payload, int ais_message_type=
 
 int AIS_CAESAR_Tx(int security_level){
 
-    int key_size=16;
-    int application_meta_size=1;
+    CaesarLevelConfig level;
+    if (!caesar_level_config(security_level, level)) {
+      printf("ERROR: SECURITY LEVEL NOT SUPPORTED!");
+      return -1;
+    }
+    int key_size = level.key_size;
     //input_digest_size, can only be 32, 48 or 64
-    int input_digest_size, output_digest_size; 
+    int input_digest_size = SHA512;
+    int output_digest_size = level.output_digest_size;
     //number of AIS type 4 messages to send before sending TESLA message
-    int number_of_messages = 1;
-
-    //when 512 digest size concatente to 384 or 392
-    switch(security_level){
-      case 0:
-        input_digest_size = SHA512;
-        output_digest_size = 49;
-        number_of_messages = 1;
-        break;
-      case 1://Tesla only, 512 digest size
-        //generate 512 bits Auth tag using HMAC
-        input_digest_size = SHA512;
-        output_digest_size = 49;
-        number_of_messages = 1;
-        break;
-      case 2:
-        //Tesla only, 160 bits digest size
-        input_digest_size = SHA512;
-        output_digest_size = 21;
-        number_of_messages = 1;
-        break;
-      case 3:
-         //Tesla +BF in same message, 256 digest size
-        input_digest_size = SHA512;
-        output_digest_size = 32;
-        number_of_messages = 2;
-        break;
-      case 4:
-        //Tesla +BF in same message, 256 digest size
-        input_digest_size = SHA512;
-        output_digest_size = 20;
-        number_of_messages = 4;
-        break;
-      /*
-      case 5:
-        //Tesla +BF(2 slots) in sep. message, 512 digest size
-        input_digest_size = SHA512;
-        output_digest_size = input_digest_size;
-        number_of_messages = 9;
-        break;*/
-      case 5:
-        //Tesla +BF(2 slots) in sep. message, 160 digest size
-        input_digest_size = SHA512;
-        output_digest_size = 20;
-        number_of_messages = 9;
-        break;
-      case 6:
-        //Tesla +BF(3 slots) in sep. message, 512 digest size
-        input_digest_size = SHA512;
-        output_digest_size = 49;
-        number_of_messages = 9;
-        break;
-
-      default:
-          printf("ERROR: SECURITY LEVEL NOT SUPPORTED!");
-        return -1;
-        break;
-    }
+    int number_of_messages = level.number_of_messages;
 
-    //SETTING UP B.F.
-    int z = MAX_SLOTS_DATA_SIZE - (output_digest_size+key_size+application_meta_size);
-
-    if(security_level==5 || security_level==6|| security_level==7){
-      z = MAX_SLOTS_DATA_SIZE - application_meta_size;
-    }
-    int k = log(2) * (z / number_of_messages);
-    BloomFilter bloomf(z*8, k);
+    //SETTING UP B.F., size and k are fixed per SECURITY_LEVEL at compile time
+    CaesarLevel<SECURITY_LEVEL>::Filter bloomf = CaesarLevel<SECURITY_LEVEL>::make_filter();
 
     //TTP, Generates Random Km and very high number n, Sends it to a ship
     int res;
@@ -312,44 +288,10 @@ int AIS_CAESAR_Tx(int security_level){
       //OCT_output(&auth_tag_message);
        if(security_level>2){
           //std::cout<<"Bloomf msg:"<<message;
-          bloomf.add((const unsigned char *)message.c_str(), message.length());
-
-          //Tests
-          if(WRITE_TESTS){
-              ofstream outfile;
-              outfile.open("test_1_sec_lvl_"+to_string(SECURITY_LEVEL)+".csv", ios::out | ios::app );
-              outfile << "\n Time taken to add/map element in B.F. in nanoseconds \n";
-              bool write_test=true;
-              for (int i=0; i<505; i++){
-                    auto start = std::chrono::high_resolution_clock::now();
-                    bloomf.add((const unsigned char *)message.c_str(), message.length());
-                    auto elapsed = std::chrono::high_resolution_clock::now() - start;
-                    long long nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
-                  //  printf("\n Time taken to add/map element in B.F. : %lld nanoseconds\n\n",  nanoseconds);
-                    write_test=false;
-
-                          
-                    // write inputted data into the file.
-                    outfile << nanoseconds << ", ";
-                            
-              }
-              
-              outfile << "\n\n Time taken to check if element in B.F. in nanoseconds \n";
-              for (int i=0; i<505; i++){
-                    auto start = std::chrono::high_resolution_clock::now();
-                    bloomf.possiblyContains((const unsigned char *)message.c_str(), message.length());
-                    auto elapsed = std::chrono::high_resolution_clock::now() - start;
-                    long long nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
-                  //  printf("\n Time taken to add/map element in B.F. : %lld nanoseconds\n\n",  nanoseconds);
-                      
-                    // write inputted data into the file.
-                    outfile << nanoseconds << ", ";
-                          
-              }
-              // close the opened file.
-              outfile.close();
-          }
-          
+          //hash the message once, digest is shared by every filter operation
+          string input = canonical_message(message);
+          auto digest = ::hash((const unsigned char *)input.data(), input.length());
+          bloomf.addHashed(digest);
       }
 
     }
@@ -418,11 +360,11 @@ int AIS_CAESAR_Tx(int security_level){
     OCT_output(&outputMAC);
 
 
-    string security_level_bits = std::bitset<3>(security_level).to_string(); 
-    string app_meta_bits = std::bitset<5>(0).to_string(); 
+    int app_meta = CAESAR_PACKED_ENCODING ? CAESAR_APPMETA_PACKED : 0;
+    string caesar_header = caesar_header_bits(security_level, app_meta);
     if(security_level == 0 ){
 
-      string payload = security_level_bits + app_meta_bits;
+      string payload = caesar_header;
       res = send_ais_message(NULL, payload, 8, NULL);
     
     }
@@ -430,7 +372,7 @@ int AIS_CAESAR_Tx(int security_level){
       //Only TESLA
       string MAC = hextobin(string(char_payload));
       string Ki_key = hextobin(string(char_key));
-      string payload = security_level_bits + app_meta_bits + Ki_key + MAC;
+      string payload = caesar_header + Ki_key + MAC;
       res = send_ais_message(NULL, payload, 8, NULL);
 
     }
@@ -441,7 +383,7 @@ int AIS_CAESAR_Tx(int security_level){
       string bf = bloomf.get_string();
       //std::cout<<"\n bf: \n"<<bf;
 
-      string payload = security_level_bits + app_meta_bits + Ki_key + MAC + bf;
+      string payload = caesar_header + Ki_key + MAC + bf;
       send_ais_message(NULL, payload, 8, NULL);
 
     }
@@ -451,14 +393,13 @@ int AIS_CAESAR_Tx(int security_level){
       string MAC = hextobin(string(char_payload));
       string Ki_key = hextobin(string(char_key));
       
-      string payload = security_level_bits + app_meta_bits + Ki_key + MAC;
+      string payload = caesar_header + Ki_key + MAC;
       //std:cout<<"\n length: "<<payload.length();
       send_ais_message(NULL, payload, 8, NULL);
 
-      //Then send B.F.
+      //Then send B.F. (xor filter for level 7)
       string bf = bloomf.get_string();
-      app_meta_bits = std::bitset<5>(1).to_string(); 
-      payload = security_level_bits + app_meta_bits + bf;
+      payload = caesar_header_bits(security_level, app_meta | CAESAR_APPMETA_FILTER) + bf;
       
       send_ais_message(NULL, payload, 8, NULL);
 
@@ -491,15 +432,6 @@ int main()
     printf("\nStarting AIS_CAESAR protocol \n");
 
     int security_level = SECURITY_LEVEL;
-    if(WRITE_TESTS){
-      ofstream outfile;
-      outfile.open("test_1_sec_lvl_"+to_string(security_level)+".csv", ios::out | ios::app );
-
-      outfile << "Security level = " << security_level<< "\n";
-              
-      // close the opened file.
-      outfile.close();
-    }
 
     auto start = std::chrono::high_resolution_clock::now();
     double vm, rss;
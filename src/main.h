@@ -15,6 +15,7 @@
 #include <chrono>
 #include "core-master/cpp/ecdh_ED25519.h"
 #include "BloomFilter.h"
+#include "CaesarLevel.h"
 #include "ais_receiver/ais_rx.h"
 #include <unistd.h>
 #include <ios>
@@ -34,13 +35,14 @@ using namespace ED25519;
 #ifndef SECURITY_LEVEL
   #define SECURITY_LEVEL 1
 #endif
-#define MAX_SLOTS 3
-#define MAX_SLOTS_DATA_SIZE 66 
 #ifndef PORT_SEND
 #define PORT_SEND 5200
 #endif
 
-#define WRITE_TESTS false
+//B.F. and HMAC input: 1 = packed frame bytes, 0 = '0'/'1' strings of older senders
+#ifndef CAESAR_PACKED_ENCODING
+#define CAESAR_PACKED_ENCODING 1
+#endif
 
 /***********************************************************
  *                                                         *
@@ -91,35 +93,47 @@ void process_mem_usage(double& vm_usage, double& resident_set)
    resident_set = rss * page_size_kb;
 }
 
-//K_input = input Key, K_output=output key, n=number of times to hash
 /**	
- *  @brief Generate keychain by hashing input consecutively n times
- *  @param octet *K_input Octet that points to input
- *  @param octet *K_output Octet that will store output
+ *  @brief Hash a key chain element in place n times, so a long walk can be done in chunks
+ *  @param octet *K element of the chain, replaced by its n-th hash
  *  @param int n number of times to hash
  *  @param int key_size truncates hash to supplied key_size bytes
  *  @return void
  */
-int generateKeyChainCommit(octet *K_input, octet *K_output, int n, int key_size){ //octet *output
+void walkKeyChain(octet *K, int n, int key_size){
 
   //create a temp octet
   char tempOctet_K_size[2 * field_size_EGS + 1];
   octet tempOctet = {0, sizeof(tempOctet_K_size), tempOctet_K_size};
-  //copy K_input into K_output
-  OCT_copy(K_output, K_input);
 
   //Use hash function iteratively
   for (int j=0; j<n; j++){
 
-    SPhash(MC_SHA2, SHA256, &tempOctet, K_output);
-    //copy temp octet into K_output
+    SPhash(MC_SHA2, SHA256, &tempOctet, K);
+    //copy temp octet into K
     if (key_size>0){
       //truncate hash to keysize
       tempOctet.len = key_size;
     }
-    OCT_copy(K_output, &tempOctet);
+    OCT_copy(K, &tempOctet);
     
   }
+}
+
+//K_input = input Key, K_output=output key, n=number of times to hash
+/**	
+ *  @brief Generate keychain by hashing input consecutively n times
+ *  @param octet *K_input Octet that points to input
+ *  @param octet *K_output Octet that will store output
+ *  @param int n number of times to hash
+ *  @param int key_size truncates hash to supplied key_size bytes
+ *  @return void
+ */
+int generateKeyChainCommit(octet *K_input, octet *K_output, int n, int key_size){ //octet *output
+
+  //copy K_input into K_output
+  OCT_copy(K_output, K_input);
+  walkKeyChain(K_output, n, key_size);
 
   return 0;
 }
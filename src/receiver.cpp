@@ -4,13 +4,125 @@
   @Description: Receiver program for implementing AIS_CAESAR Protocol PoC
   @version 1.0 25/02/19
 **/
-//g++ -O2 receiver.cpp ais_receiver/*.c core-master/cpp/core.a BloomFilter.cpp smhasher-master/src/MurmurHash3.cpp -o recvr
+//g++ -O2 receiver.cpp ais_receiver/*.c core-master/cpp/core.a BloomFilter.cpp XorFilter.cpp ReplayFilter.cpp VerifyBudget.cpp TeslaBuffer.cpp MurmurHash3Stream.cpp smhasher-master/src/MurmurHash3.cpp -lpthread -o recvr
 #include "main.h"
+#include "ReplayFilter.h"
+#include "VerifyBudget.h"
+#include "TeslaBuffer.h"
+#include "ais_receiver/ais_arena.h"
+#include "ais_receiver/caesar_reassembly.h"
+#include "ais_receiver/ais_verdicts.h"
+#include "ais_receiver/ais_slot_clock.h"
+#include "SpscQueue.h"
+#include "WorkStealingScheduler.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <pthread.h>
 
 #ifndef PORT_RECEIVE
 #define PORT_RECEIVE 51999
 #endif
 
+//Replay window: REPLAY_PARTITIONS partitions of REPLAY_PARTITION_SLOTS slots each
+#ifndef REPLAY_PARTITIONS
+#define REPLAY_PARTITIONS 4
+#endif
+#ifndef REPLAY_PARTITION_SLOTS
+#define REPLAY_PARTITION_SLOTS 4096
+#endif
+#define REPLAY_PARTITION_BITS 65536
+#define REPLAY_NUM_HASHES 11
+//repeats of one MMSI are reported at most once per REPLAY_REPORT_SLOTS slots (default one minute)
+#ifndef REPLAY_REPORT_SLOTS
+#define REPLAY_REPORT_SLOTS AIS_SLOTS_PER_MINUTE
+#endif
+//static and voyage data (type 5) and static data reports (type 24) are repeated identically by design
+#define REPLAY_CHECKED(type) ((type) != 5 && (type) != 24)
+
+//Pipeline: socket reader -> decoder -> RECEIVER_VERIFIERS verifier threads, sharded by MMSI
+#ifndef RECEIVER_VERIFIERS
+#define RECEIVER_VERIFIERS 2
+#endif
+#ifndef RECEIVER_QUEUE_DEPTH
+#define RECEIVER_QUEUE_DEPTH 1024
+#endif
+//1 = reader on core 0, decoder on core 1, verifiers on the next ones
+#ifndef RECEIVER_PIN_CORES
+#define RECEIVER_PIN_CORES 0
+#endif
+//chain hashes per verification task, so a long walk is resumed in chunks between shorter tasks
+#ifndef RECEIVER_CHAIN_CHUNK
+#define RECEIVER_CHAIN_CHUNK 64
+#endif
+//Verification budget, in hashes (SHA-256 chain steps and SHA-512 HMAC blocks) and slots of the
+//receiver's slot clock (26.67 ms): by default 150 hashes/s per MMSI and 19200 hashes/s in all
+#ifndef RECEIVER_MAX_CHAIN_WALK
+#define RECEIVER_MAX_CHAIN_WALK 4096
+#endif
+#ifndef RECEIVER_MMSI_HASH_RATE
+#define RECEIVER_MMSI_HASH_RATE 4
+#endif
+#ifndef RECEIVER_MMSI_HASH_BURST
+#define RECEIVER_MMSI_HASH_BURST 2048
+#endif
+#ifndef RECEIVER_GLOBAL_HASH_RATE
+#define RECEIVER_GLOBAL_HASH_RATE 512
+#endif
+#ifndef RECEIVER_GLOBAL_HASH_BURST
+#define RECEIVER_GLOBAL_HASH_BURST 65536
+#endif
+//percent of the global budget kept for senders whose key has verified
+#ifndef RECEIVER_BUDGET_RESERVE
+#define RECEIVER_BUDGET_RESERVE 25
+#endif
+#ifndef RECEIVER_BUDGET_SENDERS
+#define RECEIVER_BUDGET_SENDERS 65536
+#endif
+//TESLA buffer: intervals between an interval and the disclosure of its key, and slots (26.67 ms)
+//an interval waits for its key before its messages are purged unverified
+#ifndef RECEIVER_TESLA_DISCLOSURE_DELAY
+#define RECEIVER_TESLA_DISCLOSURE_DELAY 0
+#endif
+#ifndef RECEIVER_TESLA_EXPIRY_SLOTS
+#define RECEIVER_TESLA_EXPIRY_SLOTS 4096
+#endif
+//disclosures of one MMSI waiting for the one being verified
+#ifndef RECEIVER_TESLA_MAX_WAITING
+#define RECEIVER_TESLA_MAX_WAITING 8
+#endif
+//datagram socket of the verdict consumer, "" for no verdict stream
+#ifndef RECEIVER_VERDICT_SOCKET
+#define RECEIVER_VERDICT_SOCKET "/tmp/caesar_verdicts.sock"
+#endif
+//queue depths are printed every RECEIVER_METRICS_FRAMES frames
+#ifndef RECEIVER_METRICS_FRAMES
+#define RECEIVER_METRICS_FRAMES 1000
+#endif
+
+//frame as read from a source, before decoding
+struct RawFrame {
+    uint8_t frame[AIS_MAX_FRAME_BYTES];
+    uint16_t len;
+    uint8_t source;
+};
+
+typedef SpscQueue<RawFrame, RECEIVER_QUEUE_DEPTH> FrameQueue;
+typedef SpscQueue<ais_message_t, RECEIVER_QUEUE_DEPTH> MessageQueue;
+struct VerifyJob;
+typedef WorkStealingScheduler<VerifyJob *> VerifyScheduler;
+
+//jobs finished by another verifier, handed back to the one whose TESLA buffer holds their epoch
+struct SettledJobs {
+    SettledJobs() : count(0) {}
+    std::mutex lock;
+    std::vector<VerifyJob *> jobs;
+    std::atomic<size_t> count;
+};
+
 
 /**	
  *  @brief Convert binary string to hex string
@@ -37,7 +149,469 @@ std::string bintohex(const std::string &s){
     return out;
 }
 
-int main(void)
+/**	
+ *  @brief Append an octet as a hex line to a verification log
+ *  @param std::string &out
+ *  @param octet *o
+ *  @return void
+ */
+void append_octet(std::string &out, octet *o)
+{
+    std::vector<char> hex(2 * o->len + 1, 0);
+    OCT_toHex(o, hex.data());
+    out += hex.data();
+    out += "\n";
+}
+
+/*
+ * Verification of one disclosure, run by the scheduler as a sequence of tasks: the key chain
+ * walk from Ki back to K0 (RECEIVER_CHAIN_CHUNK hashes per task), the HMAC of the epoch and
+ * the B.F. check. Everything the tasks need is copied from the history when the job is made,
+ * so any verifier can run them; the records of the epoch and of the disclosure are only written
+ * back through their auth byte, and their verdict is published by the verifier that finishes
+ * the job. A key that does not verify only fails the disclosure: the epoch stays pending in the
+ * TESLA buffer of the owner, which settles the job. The output of a job is printed in one piece
+ * once it is done. Jobs of levels with a filter are a FilterVerifyJob, holding the filter.
+ */
+struct VerifyJob {
+    enum Stage { CHAIN_WALK, MAC, FILTER, VERDICT };
+
+    VerifyJob(int security_level, int input_digest_size, int output_digest_size, int key_size, int auth_tag_size)
+        : m_stage(CHAIN_WALK), m_mmsi(0), m_slot(0), m_owner(0), m_budget(NULL), m_hashes(0), m_securityLevel(security_level),
+          m_inputDigestSize(input_digest_size), m_outputDigestSize(output_digest_size), m_keySize(key_size), m_chainRemaining(0), m_failed(false),
+          m_authTagBuf(auth_tag_size), m_macBuf(output_digest_size * 2), m_macRecvdBuf(output_digest_size * 2)
+    {
+        m_Ki = {0, sizeof(m_KiBuf), m_KiBuf};
+        m_K = {0, sizeof(m_KBuf), m_KBuf};
+        m_authTag = {0, static_cast<int>(m_authTagBuf.size()), m_authTagBuf.data()};
+        m_mac = {0, static_cast<int>(m_macBuf.size()), m_macBuf.data()};
+        m_macRecvd = {0, static_cast<int>(m_macRecvdBuf.size()), m_macRecvdBuf.data()};
+    }
+
+    virtual ~VerifyJob() {}
+
+    /**	
+     *  @brief Check a message of the epoch against the filter of the disclosure
+     *  @param const ais_message_t &m
+     *  @return false, levels without filter
+     */
+    virtual bool contains(const ais_message_t &m) const { return false; }
+
+    /**	
+     *  @brief Run the next task of the job
+     *  @param ais_verdict_stream_t *verdicts stream of the calling verifier
+     *  @return true once the job is done, false if it has to be resumed
+     */
+    bool run(ais_verdict_stream_t *verdicts)
+    {
+        switch (m_stage) {
+            case CHAIN_WALK: {
+                int n = std::min(m_chainRemaining, RECEIVER_CHAIN_CHUNK);
+                walkKeyChain(&m_K, n, m_keySize);
+                m_chainRemaining -= n;
+                if (m_chainRemaining == 0) {
+                    m_log += "\n Ki(Hi(Ki)) == K0? :\n";
+                    append_octet(m_log, &m_K);
+                    m_stage = MAC;
+                }
+                return false;
+            }
+            case MAC:
+                m_log += "\n outputMAC_recvd:\n ";
+                append_octet(m_log, &m_macRecvd);
+                HMAC(MC_SHA2, m_inputDigestSize, &m_mac, m_outputDigestSize, &m_Ki, &m_authTag);
+                m_log += "\n outputMAC:\n ";
+                append_octet(m_log, &m_mac);
+                m_stage = m_filterRecords.empty() ? VERDICT : FILTER;
+                return false;
+            case FILTER:
+                for (auto &r : m_filterRecords) {
+                    m_log += "\n Contains ais message 4 received#" + std::to_string(r.first) + "\t";
+                    m_log += contains(*r.second) ? "true" : "false";
+                }
+                m_stage = VERDICT;
+                return false;
+            case VERDICT:
+                break;
+        }
+
+        if (!OCT_comp(&m_K, m_K0)) {
+            m_log += "\n*** Key exchanged Failed\n";
+            m_failed = true;
+        } else {
+            m_log += "\n*** Key K0 exchanged matches! \n";
+            if (!OCT_comp(&m_mac, &m_macRecvd)) {
+                m_log += "*** MAC tag exchanged Failed\n";
+                m_failed = true;
+            } else {
+                m_log += "*** MAC tag matches! \n";
+            }
+        }
+        //the MMSI of a failed disclosure is not authenticated, its epoch waits for another key
+        if (!m_failed)
+            mark_auth(m_epoch, AIS_AUTH_VERIFIED, verdicts);
+        mark_auth(m_disclosure, m_failed ? AIS_AUTH_FAILED : AIS_AUTH_VERIFIED, verdicts);
+        if (m_budget)
+            m_budget->report(m_mmsi, m_slot, !m_failed, m_hashes);
+        fputs(m_log.c_str(), stdout);
+        fflush(stdout);
+        return true;
+    }
+
+    /**	
+     *  @brief Set and publish the authentication status of the messages of an epoch
+     *  @param const std::vector<ais_message_t *> &epoch records covered by the MAC tag
+     *  @param uint8_t auth AIS_AUTH_*
+     *  @param ais_verdict_stream_t *verdicts
+     *  @return void
+     */
+    static void mark_auth(const std::vector<ais_message_t *> &epoch, uint8_t auth, ais_verdict_stream_t *verdicts)
+    {
+        //records belong to the arena of the verifier that made the job, which releases them once it settles
+        for (ais_message_t *m : epoch) {
+            __atomic_store_n(&m->auth, auth, __ATOMIC_RELAXED);
+            ais_verdicts_add(verdicts, m, auth);
+        }
+    }
+
+    Stage m_stage;
+    uint32_t m_mmsi;
+    uint32_t m_slot;                        //of the disclosure
+    int m_owner;                            //verifier whose TESLA buffer holds the epoch
+    VerifyBudget *m_budget;                 //told the outcome
+    uint32_t m_hashes;                      //charged to the budget
+    int m_securityLevel;
+    int m_inputDigestSize;
+    int m_outputDigestSize;
+    int m_keySize;
+    int m_chainRemaining;                   //hashes left from Ki to K0
+    bool m_failed;                          //key or MAC tag does not verify
+
+    char m_KiBuf[2 * field_size_EGS];
+    char m_KBuf[2 * field_size_EGS];
+    std::vector<char> m_authTagBuf;
+    std::vector<char> m_macBuf;
+    std::vector<char> m_macRecvdBuf;
+    octet m_Ki;                             //disclosed key
+    octet m_K;                              //Ki hashed along the chain, K0 once the walk is done
+    octet m_authTag;                        //HMAC input of the epoch
+    octet m_mac;
+    octet m_macRecvd;
+    octet *m_K0;                            //commitment of the transmitter
+
+    std::vector<ais_message_t *> m_epoch;
+    std::vector<ais_message_t *> m_disclosure;  //TESLA message, and the B.F. message of levels 5-7
+    //messages to check against the filter, numbered as received
+    std::vector<std::pair<int, const ais_message_t *>> m_filterRecords;
+    std::string m_log;
+};
+
+/**	
+ *  @brief Verification job of a security level with a filter, the filter is loaded from a received message and kept by value
+ */
+template <class L>
+struct FilterVerifyJob : VerifyJob {
+    /**	
+     *  @param const ais_message_t &d message carrying the filter
+     *  other parameters as VerifyJob
+     */
+    FilterVerifyJob(const ais_message_t &d, int security_level, int input_digest_size, int output_digest_size,
+                    int key_size, int auth_tag_size)
+        : VerifyJob(security_level, input_digest_size, output_digest_size, key_size, auth_tag_size),
+          m_filter(L::make_filter()), m_encoding(d.encoding)
+    {
+        //levels 3-4: B.F. is at the tail of the TESLA message, levels 5-7: the whole payload of this message
+        if (L::separate_filter)
+            m_filter.to_bits(protodec_bits(&d, d.payload_offset, d.payload_bits));
+        else
+            m_filter.to_bits(protodec_bits(&d, d.payload_offset + d.payload_bits - L::filter_bits, L::filter_bits));
+    }
+
+    bool contains(const ais_message_t &m) const
+    {
+        //digest of the packed frame was computed once when the message was decoded
+        if (m_encoding == CAESAR_ENCODING_PACKED)
+            return m_filter.containsHashed(m.digest);
+        std::string message = protodec_bits(&m, 0, m.bit_cnt);
+        return m_filter.possiblyContains((const unsigned char *)message.c_str(), message.length());
+    }
+
+    typename L::Filter m_filter;
+    int m_encoding;                         //announced by the sender
+};
+
+//makes the VerifyJob of the CaesarLevel it is called with
+struct VerifyJobFactory {
+    const ais_message_t &d;
+    int security_level;
+    int input_digest_size;
+    int auth_tag_size;
+    VerifyJob *job;
+
+    template <class L> void operator()(L) { make<L>(std::integral_constant<bool, (L::filter_bits > 0)>()); }
+    template <class L> void make(std::false_type)
+    {
+        job = new VerifyJob(security_level, input_digest_size, L::output_digest_size, L::key_size, auth_tag_size);
+    }
+    template <class L> void make(std::true_type)
+    {
+        job = new FilterVerifyJob<L>(d, security_level, input_digest_size, L::output_digest_size, L::key_size, auth_tag_size);
+    }
+};
+
+/**	
+ *  @brief Hand records no longer referenced by the TESLA buffer or a job back to the arena of the calling verifier
+ *  @param const std::vector<ais_message_t *> &records committed records of this verifier
+ *  @return void
+ */
+void release_records(const std::vector<ais_message_t *> &records)
+{
+    AisArena &history = ais_thread_arena();
+    for (ais_message_t *m : records)
+        history.release(m);
+}
+
+/**	
+ *  @brief Publish the final verdict of records and release them
+ *  @param const std::vector<ais_message_t *> &records committed records of this verifier
+ *  @param uint8_t auth AIS_AUTH_*
+ *  @param ais_verdict_stream_t *verdicts
+ *  @return void
+ */
+void retire_records(const std::vector<ais_message_t *> &records, uint8_t auth, ais_verdict_stream_t *verdicts)
+{
+    VerifyJob::mark_auth(records, auth, verdicts);
+    release_records(records);
+}
+
+/**	
+ *  @brief Print memory use, depth, high-water mark and producer stalls of the pipeline queues, and the verification tasks
+ *  @param const FrameQueue &frames reader -> decoder queue
+ *  @param const std::vector<std::unique_ptr<MessageQueue>> &shards decoder -> verifier queues
+ *  @param const VerifyScheduler &scheduler verification tasks shared by the verifiers
+ *  @param const VerifyBudget &budget disclosures admitted and refused
+ *  @return void
+ */
+void print_queue_metrics(const FrameQueue &frames, const std::vector<std::unique_ptr<MessageQueue>> &shards,
+                         const VerifyScheduler &scheduler, const VerifyBudget &budget)
+{
+    double vm, rss;
+    process_mem_usage(vm, rss);
+    printf("VM: %.0f KB; RSS: %.0f KB\n", vm, rss);
+    printf("queues: frames %zu/%zu max %zu stalls %llu", frames.depth(), frames.capacity(),
+           frames.max_depth(), (unsigned long long)frames.stalls());
+    for (size_t i = 0; i < shards.size(); i++)
+        printf(", verifier %zu %zu max %zu stalls %llu", i, shards[i]->depth(), shards[i]->max_depth(),
+               (unsigned long long)shards[i]->stalls());
+    printf("; tasks %zu", scheduler.pending());
+    for (int i = 0; i < scheduler.workers(); i++)
+        printf(", verifier %d steals %llu resumed %llu", i, (unsigned long long)scheduler.steals(i),
+               (unsigned long long)scheduler.resumed(i));
+    printf("; disclosures admitted %llu", (unsigned long long)budget.count(VerifyBudget::ADMITTED));
+    for (int a = VerifyBudget::ADMITTED + 1; a < VerifyBudget::NUM_ADMIT; a++)
+        printf(", %s %llu", VerifyBudget::reason((VerifyBudget::Admit)a),
+               (unsigned long long)budget.count((VerifyBudget::Admit)a));
+    printf("\n");
+    fflush(stdout);
+}
+
+/**	
+ *  @brief Pin a pipeline thread to a core (modulo the cores available) if RECEIVER_PIN_CORES is set
+ *  @param std::thread &t
+ *  @param int core
+ *  @return void
+ */
+void pin_thread(std::thread &t, int core)
+{
+    if (!RECEIVER_PIN_CORES)
+        return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core % std::max(1u, std::thread::hardware_concurrency()), &set);
+    if (pthread_setaffinity_np(t.native_handle(), sizeof(set), &set) != 0)
+        printf("Thread could not be pinned to core %d\n", core);
+}
+
+/**	
+ *  @brief Verification job of a key disclosure, against the interval it discloses
+ *  @param uint32_t mmsi transmitter
+ *  @param const TeslaDisclosure &d disclosure, the one being verified for mmsi in tesla_buffer
+ *  @param TeslaBuffer &tesla_buffer intervals of the transmitters of this verifier
+ *  @param octet &K0 key chain commitment of the transmitter
+ *  @param VerifyBudget &budget hashes left for verification
+ *  @param ais_verdict_stream_t *verdicts verdicts of the disclosure if it is not verified
+ *  @param int owner verifier of tesla_buffer
+ *  @return verification job, NULL if no interval is buffered or the budget refuses it
+ */
+VerifyJob *make_verify_job(uint32_t mmsi, const TeslaDisclosure &d, TeslaBuffer &tesla_buffer, octet &K0,
+                           VerifyBudget &budget, ais_verdict_stream_t *verdicts, int owner)
+{
+    const ais_message_t &msg = *d.message;
+    ais_message_t *tesla = d.key;
+    int security_level = msg.security_level;
+    CaesarLevelConfig level;
+    caesar_level_config(security_level, level);
+    int key_size = level.key_size;
+    int input_digest_size = SHA512, output_digest_size = level.output_digest_size;
+
+    std::vector<ais_message_t *> disclosure(1, tesla);
+    if (tesla != d.message)
+        disclosure.push_back(d.message);
+
+    //exactly the interval disclosed, it stays buffered until the job settles
+    TeslaInterval interval;
+    if (!tesla_buffer.disclosed(mmsi, d, interval)) {
+        printf("*** Disclosure of MMSI %lu not verified: no buffered interval\n", (unsigned long)mmsi);
+        retire_records(disclosure, AIS_AUTH_UNVERIFIED, verdicts);
+        return NULL;
+    }
+    std::string temp = bintohex(protodec_bits(tesla, tesla->payload_offset, tesla->payload_bits));
+
+    //Complete Auth tag will be stored, the filter of levels 3-7 is loaded from msg
+    VerifyJobFactory factory = {msg, security_level, input_digest_size, level.number_of_messages * field_size_EFS + 1, NULL};
+    caesar_level_dispatch(security_level, factory);
+    VerifyJob *job = factory.job;
+    job->m_K0 = &K0;
+    job->m_mmsi = mmsi;
+    job->m_slot = d.slot;
+    job->m_owner = owner;
+    job->m_disclosure = disclosure;
+    job->m_epoch = interval.messages;
+
+    //HMAC input in the encoding announced by the sender, in the order the messages were sent
+    for (const ais_message_t *it : interval.messages) {
+        const ais_message_t &m = *it;
+        if (msg.encoding == CAESAR_ENCODING_PACKED){
+            OCT_jbytes(&job->m_authTag, (char *) m.frame, m.byte_cnt);
+        }else{
+            std::string message = protodec_bits(&m, 0, m.bit_cnt);
+            OCT_jstring(&job->m_authTag, (char *) message.data() );
+        }
+    }
+
+    //Extract key and MAC tag from the TESLA message
+    OCT_fromHex(&job->m_Ki, (char *) temp.substr(0, key_size*2).data()); 
+    OCT_fromHex(&job->m_macRecvd, (char *) temp.substr(key_size*2, output_digest_size*2).data()); 
+    job->m_log = "\nith_timeslot: " + std::to_string(interval.timeslots) + "\n Ki:\n ";
+    append_octet(job->m_log, &job->m_Ki);
+
+    //chain walk and HMAC blocks are charged before any hashing, forged disclosures included
+    int ith_timeslot = interval.timeslots;
+    int hashes = ith_timeslot + job->m_authTag.len / 128 + 3;
+    VerifyBudget::Admit admit = budget.admit(mmsi, d.slot, ith_timeslot, interval.messages.size(), hashes);
+    if (admit != VerifyBudget::ADMITTED) {
+        printf("*** Verification refused for MMSI %lu: %s\n", (unsigned long)mmsi, VerifyBudget::reason(admit));
+        retire_records(job->m_disclosure, AIS_AUTH_UNVERIFIED, verdicts);
+        delete job;
+        return NULL;
+    }
+    job->m_budget = &budget;
+    job->m_hashes = hashes;
+
+    //Key verification, walked by the scheduler
+    OCT_copy(&job->m_K, &job->m_Ki);
+    job->m_chainRemaining = ith_timeslot;
+
+    //Messages are numbered as received in the interval, up to its ith_timeslot.
+    if (level.has_filter) {
+        int k = ith_timeslot;
+        for (auto it = interval.messages.rbegin(); it != interval.messages.rend() && k > 0; ++it, k--)
+            job->m_filterRecords.push_back(std::make_pair(k, *it));
+    }
+    return job;
+}
+
+/**	
+ *  @brief Settle the disclosure of a transmitter being verified, and start the next one waiting
+ *  @param uint32_t mmsi transmitter
+ *  @param bool verified outcome of the disclosure, false if it was not verified at all
+ *  @param TeslaBuffer &tesla_buffer intervals of the transmitters of this verifier
+ *  @param octet &K0 key chain commitment of the transmitter
+ *  @param VerifyBudget &budget hashes left for verification
+ *  @param ais_verdict_stream_t *verdicts verdicts of messages not verified
+ *  @param int owner verifier of tesla_buffer
+ *  @return verification job of the next disclosure of mmsi, NULL if none waits
+ */
+VerifyJob *settle_disclosure(uint32_t mmsi, bool verified, TeslaBuffer &tesla_buffer, octet &K0,
+                             VerifyBudget &budget, ais_verdict_stream_t *verdicts, int owner)
+{
+    std::vector<ais_message_t *> purged;
+    TeslaDisclosure next;
+    while (true) {
+        purged.clear();
+        bool waiting = tesla_buffer.settle(mmsi, verified, purged, next);
+        retire_records(purged, AIS_AUTH_UNVERIFIED, verdicts);
+        if (!waiting)
+            return NULL;
+        VerifyJob *job = make_verify_job(mmsi, next, tesla_buffer, K0, budget, verdicts, owner);
+        if (job)
+            return job;
+        verified = false;
+    }
+}
+
+/**	
+ *  @brief CAESAR verification of a decoded message: messages are buffered in the interval of their
+ *  transmitter, a disclosure is verified against the interval it discloses by the returned job
+ *  @param ais_message_t &msg message to verify, the record acquired last from history
+ *  @param TeslaBuffer &tesla_buffer intervals of the transmitters of this verifier
+ *  @param octet &K0 key chain commitment of the transmitter
+ *  @param VerifyBudget &budget hashes left for verification
+ *  @param ais_verdict_stream_t *verdicts verdicts of messages not verified
+ *  @param int owner verifier of tesla_buffer
+ *  @return verification job of the disclosure, NULL if msg discloses no key or the disclosure is not verified now
+ */
+VerifyJob *verify_message(ais_message_t &msg, TeslaBuffer &tesla_buffer, octet &K0, VerifyBudget &budget,
+                          ais_verdict_stream_t *verdicts, int owner)
+{
+    if(AIS_IS_CAESAR_BINARY(msg.type)){
+        printf("security_level: %d\r\n", msg.security_level);
+    }
+
+    //plain message (or no CAESAR level), covered by the MAC tag of the interval it falls in
+    int security_level = AIS_IS_CAESAR_BINARY(msg.type) ? msg.security_level : 0;
+    CaesarLevelConfig level;
+    if (security_level == 0 || !caesar_level_config(security_level, level)) {
+        tesla_buffer.add(&msg);
+        return NULL;
+    }
+
+    //levels 5-7: the key is disclosed by the TESLA message, verified once its B.F. message follows
+    ais_message_t *tesla = &msg;
+    if (security_level >= 5 && msg.appmeta_bits != 1) {
+        ais_message_t *previous = tesla_buffer.hold_key(&msg);
+        if (previous)
+            retire_records(std::vector<ais_message_t *>(1, previous), AIS_AUTH_UNVERIFIED, verdicts);
+        return NULL;
+    }
+    if (security_level >= 5)
+        tesla = tesla_buffer.take_key(msg.src_mmsi);
+    if (!tesla) {
+        printf("*** Disclosure of MMSI %lu not verified: no key\n", (unsigned long)msg.src_mmsi);
+        retire_records(std::vector<ais_message_t *>(1, &msg), AIS_AUTH_UNVERIFIED, verdicts);
+        return NULL;
+    }
+
+    TeslaDisclosure d = {tesla, &msg, msg.slot, 0};
+    switch (tesla_buffer.disclose(msg.src_mmsi, d)) {
+        case TeslaBuffer::VERIFY:
+            break;
+        case TeslaBuffer::WAITING:
+            return NULL;
+        case TeslaBuffer::DROPPED:
+            printf("*** Disclosure of MMSI %lu not verified: too many disclosures waiting\n", (unsigned long)msg.src_mmsi);
+            retire_records(std::vector<ais_message_t *>(1, &msg), AIS_AUTH_UNVERIFIED, verdicts);
+            if (tesla != &msg)
+                retire_records(std::vector<ais_message_t *>(1, tesla), AIS_AUTH_UNVERIFIED, verdicts);
+            return NULL;
+    }
+    VerifyJob *job = make_verify_job(msg.src_mmsi, d, tesla_buffer, K0, budget, verdicts, owner);
+    if (!job)
+        job = settle_disclosure(msg.src_mmsi, false, tesla_buffer, K0, budget, verdicts, owner);
+    return job;
+}
+
+int main(int argc, char **argv)
 {
     AISConfiguration ais_config;
 
@@ -45,338 +619,203 @@ int main(void)
     char s0[2 * field_size_EGS];
     octet K0 = {0, sizeof(s0), s0};
     OCT_fromHex(&K0, (char *) "3befe8479939cbb8772d4fd0985a2502" ); 
-    int ith_timeslot=0;//ith timeslot for TESLA 
 
-    bool repeated_message = false;
-    
-    std::vector<ais_message_t> ais_vector;
-    int fd1, message_count, last_count;
-    
-    message_count = 0;
-    do {
-        sleep(1);
-        fd1 = socket_init(PORT_RECEIVE);
-    }while(fd1 == -1);
-    printf("CAESAR Receiver Connected!\n");
+    ReplayFilter replay_filter(REPLAY_PARTITIONS, REPLAY_PARTITION_SLOTS, REPLAY_PARTITION_BITS, REPLAY_NUM_HASHES);
+    //per MMSI: slot of the last replay report, repeats heard since
+    struct ReplayReport { uint32_t slot; unsigned long suppressed; };
+    std::unordered_map<uint32_t, ReplayReport> replay_reports;
+    //CAESAR payloads split over several messages, per source MMSI
+    static caesar_reassembly_t reassembly;
+    caesar_reassembly_init(&reassembly);
+
+    //every receive chain (channel A/B, other SDRs) is a source of the same epoll loop
+    static ais_source_set_t sources;
+    if (ais_sources_init(&sources) != 0)
+        return -1;
+    for (int i = 1; i < argc; i++)
+        ais_sources_add(&sources, argv[i], AIS_STREAM_FRAMING);
+    if (argc < 2) {
+        //socket PDU block of the flowgraph as UDP client: one datagram is one PDU, whatever the framing
+        char spec[32];
+        snprintf(spec, sizeof(spec), "udp:localhost:%d", PORT_RECEIVE);
+        ais_sources_add(&sources, spec, AIS_STREAM_FRAMING);
+    }
+    if (sources.count == 0) {
+        printf("Usage: %s [[raw+|kiss+|len+|nmea+]tcp:host:port | udp:host:port | unix:path ...]\n", argv[0]);
+        return -1;
+    }
+    printf("CAESAR Receiver started, %d sources, %d verifiers\n", sources.count, RECEIVER_VERIFIERS);
     printf("Transmitter Key K0:\n");
     OCT_output(&K0);
 
     load_configuration(NULL, &ais_config);
 
-    while(true){
-
-        double vm, rss;
-        process_mem_usage(vm, rss);
-        std::cout << "\n VM: " << vm << "; RSS: " << rss << std::endl;
-        std::cout << "ith_timeslot: " << ith_timeslot << std::endl;
-        ais_message_t ais[1];
-        ais[message_count].fd = fd1;
-        ais[message_count].d.seqnr = 0;
-        bool nextBloomf=false;
-        
-        read_ais_message(&ais[message_count]);
-
-        if(ais[message_count].d.type == 8){
-            printf("security_level: %d\r\n", ais[message_count].d.security_level);
-        }
-       
-        if(ais[message_count].d.type == 8 ){
-           
-            std::string temp = bintohex(std::string(ais[message_count].d.payload_buffer));
-           // std::cout<<"\n Temp: \n"<<temp;
-
-            //CAESAR config
-            int security_level=ais[message_count].d.security_level;
-            int application_meta_size=1;
-            int key_size=16;
-            //input_digest_size, can only be 32, 48 or 64
-            int input_digest_size, output_digest_size; 
-            //number of AIS type 4 messages to send
-            int number_of_messages = 1;
-            bool sendBF = false;
-
-            //when 512 digest size concatente to 384 or 392(separate)
-            switch(security_level){
-                case 1://Tesla only, 512 digest size
-                    //generate 512 bits Auth tag using HMAC
-                    input_digest_size = SHA512;
-                    output_digest_size = 49;
-                    number_of_messages = 1;
-                    break;
-                case 2:
-                    //Tesla only, 160 bits digest size
-                    input_digest_size = SHA512;
-                    output_digest_size = 21;
-                    number_of_messages = 1;
-                    break;
-                case 3:
-                    //Tesla +BF in same message, 256 digest size
-                    input_digest_size = SHA512;
-                    output_digest_size = 32;
-                    number_of_messages = 2;
-                    sendBF = true;
-                    break;
-                case 4:
-                    //Tesla +BF in same message, 256 digest size
-                    input_digest_size = SHA512;
-                    output_digest_size = 20;
-                    number_of_messages = 4;
-                    sendBF = true;
-                    break;
-                /*
-                case 5:
-                    //Tesla +BF(2 slots) in sep. message, 512 digest size
-                    input_digest_size = SHA512;
-                    output_digest_size = input_digest_size;
-                    number_of_messages = 9;
-                    sendBF = true;
-                    break;*/
-                case 5:
-                    //Tesla +BF(2 slots) in sep. message, 160 digest size
-                    input_digest_size = SHA512;
-                    output_digest_size = 20;
-                    number_of_messages = 9;
-                    sendBF = true;
-                    break;
-                case 6:
-                    //Tesla +BF(3 slots) in sep. message, 512 digest size
-                    input_digest_size = SHA512;
-                    output_digest_size = 49;
-                    number_of_messages = 9;
-                    sendBF = true;
-                    break;
-
-                default:
-                    break;
-            }
-
-            //Complete Auth tag will be stored
-            char auth_tag_message_size[number_of_messages * field_size_EFS + 1];
-            octet auth_tag_message = {0, static_cast<int> (sizeof(auth_tag_message_size)), auth_tag_message_size};
-        
-            char s1[2 * field_size_EGS], s2[2 * field_size_EGS], z0[output_digest_size*2], z1[output_digest_size*2];
-            octet K0_recvd = {0, sizeof(s1), s1};
-            octet Ki = {0, sizeof(s2), s2};
-
-            octet outputMAC = {0, static_cast<int> (sizeof(z0)), z0};
-            octet outputMAC_recvd = {0, static_cast<int> (sizeof(z1)), z1};
-
-
-            for(int j = ais_vector.size()-1; j >= 0; j--) {
-                    //go back till last message==8 or source MMSI is equal 
-                    if ( ais_vector[j].d.type == 8 && ais_vector[j].d.appmeta_bits==1 && ais_vector[j].d.security_level >= 5 ){
-                        break;
-                    }
-                    else if ( ais_vector[j].d.type == 8 && ais_vector[j].d.appmeta_bits==0 && ais_vector[j].d.security_level >= 5 ){
-                        continue;
-                    }
-                    else if ( security_level <5 && ais_vector[j].d.type == 8  ){
-                        break;
-                    }
-                    
-                    //std::cout<<"\n message: "<<j<< " \n"<<ais_vector[j].d.type;
-                    std::string message = ais_vector[j].d.message;
-
-                //  std::cout<<"\n message: "<<j<< " \n"<<message.data();
-                //  printf("\n OCT output");
-                    OCT_jstring(&auth_tag_message, (char *) message.data() );
-                //  OCT_output(&auth_tag_message);
-            }
-            
-        /*
-        if(auth_tag_message.len <1){
-            printf("\n OCT output");
-            OCT_output(&auth_tag_message);
-            //   continue;
-        }*/
-
-        if(security_level == 1 || security_level == 2 ){
-            //Extract key from message
-            OCT_fromHex(&Ki, (char *) temp.substr(0, key_size*2).data()); 
-            printf("\n Ki:\n ");
-            OCT_output(&Ki);
-
-            //Key verification
-            generateKeyChainCommit(&Ki, &K0_recvd, ith_timeslot, key_size);
-
-            printf("\n Ki(Hi(Ki)) == K0? :\n");
-            OCT_output(&K0_recvd);
-
-
-            OCT_fromHex(&outputMAC_recvd, (char *) temp.substr(key_size*2, output_digest_size*2).data()); 
-            printf("\n outputMAC_recvd:\n ");
-            OCT_output(&outputMAC_recvd);
-
-            HMAC(MC_SHA2, input_digest_size, &outputMAC, output_digest_size, &Ki, &auth_tag_message);
-            printf("\n outputMAC:\n ");
-            OCT_output(&outputMAC);
-            
-            
-            if (!OCT_comp(&K0_recvd, &K0))
-            {
-                printf("*** Key exchanged Failed\n");
-                return -1;
-            }else{
-                printf("*** Key K0 exchanged matches! \n");
+    //reader -> decoder -> verifier of the shard of the MMSI, so frames of a transmitter stay in order.
+    //The hashing of the disclosures goes to the scheduler, where idle verifiers steal it.
+    std::unique_ptr<FrameQueue> frames(new FrameQueue());
+    std::vector<std::unique_ptr<MessageQueue>> shards;
+    for (int i = 0; i < RECEIVER_VERIFIERS; i++)
+        shards.emplace_back(new MessageQueue());
+    VerifyScheduler scheduler(RECEIVER_VERIFIERS);
+    std::vector<std::unique_ptr<SettledJobs>> settled;
+    for (int i = 0; i < RECEIVER_VERIFIERS; i++)
+        settled.emplace_back(new SettledJobs());
+    VerifyBudget budget(RECEIVER_MAX_CHAIN_WALK, RECEIVER_MMSI_HASH_RATE, RECEIVER_MMSI_HASH_BURST, RECEIVER_GLOBAL_HASH_RATE,
+                        RECEIVER_GLOBAL_HASH_BURST, RECEIVER_BUDGET_RESERVE, RECEIVER_BUDGET_SENDERS);
+
+    std::thread reader([&]{
+        RawFrame f;
+        int source;
+        while (true) {
+            int len = ais_sources_next(&sources, f.frame, AIS_MAX_FRAME_BYTES, &source);
+            if (len < 0) {
+                printf("no receive source\n");
+                fflush(stdout);
+                exit(EXIT_FAILURE);
             }
-            
-            if (!OCT_comp(&outputMAC, &outputMAC_recvd))
-            {
-                printf("*** MAC tag exchanged Failed\n");
-                return -1;
-            }else{
-                printf("*** MAC tag matches! \n");
+            f.len = len;
+            f.source = source;
+            frames->push(f);
+        }
+    });
+
+    std::thread decoder([&]{
+        static ais_message_t msg;
+        RawFrame f;
+        for (unsigned long n = 1; ; n++) {
+            frames->pop(f);
+            memcpy(msg.frame, f.frame, f.len);
+            decode_ais_frame(&msg, f.len);
+            msg.source = f.source;
+            //copies of the frame heard by another chain
+            if (ais_sources_duplicate(&sources, msg.digest, msg.source))
+                continue;
+
+            //frames already heard from the same MMSI within the replay window, which follows the slot clock
+            uint32_t now = ais_slot_now();
+            replay_filter.advance_to(now);
+            if(REPLAY_CHECKED(msg.type) && replay_filter.checkAndAdd(msg.digest, msg.src_mmsi)){
+                auto found = replay_reports.find(msg.src_mmsi);
+                if (found == replay_reports.end() || now - found->second.slot >= REPLAY_REPORT_SLOTS) {
+                    printf("*** Possible replay: frame from MMSI %lu already received in the last %llu slots",
+                           (unsigned long)msg.src_mmsi, (unsigned long long)replay_filter.window_slots());
+                    if (found != replay_reports.end() && found->second.suppressed)
+                        printf(" (%lu more repeats since the last report)", found->second.suppressed);
+                    printf("\n");
+                    //forged MMSIs must not grow it without bound, forgetting only costs an early report
+                    if (replay_reports.size() >= RECEIVER_BUDGET_SENDERS)
+                        replay_reports.clear();
+                    replay_reports[msg.src_mmsi] = {now, 0};
+                } else
+                    found->second.suppressed++;
             }
-            ith_timeslot = 0;
-
-        } else if(security_level == 3 || security_level == 4 ){
-                    OCT_fromHex(&Ki, (char *) temp.substr(0, key_size*2).data()); 
-                    printf("\n Ki:\n ");
-                    OCT_output(&Ki);
-
-                    //Key verification
-                    generateKeyChainCommit(&Ki, &K0_recvd, ith_timeslot, key_size);
-
-                    printf("\n Ki(Hi(Ki)) == K0? :\n");
-                    OCT_output(&K0_recvd);
-
-                    OCT_fromHex(&outputMAC_recvd, (char *) temp.substr(key_size*2, output_digest_size*2).data()); 
-                    printf("\n outputMAC_recvd:\n ");
-                    OCT_output(&outputMAC_recvd);
-
-                    HMAC(MC_SHA2, input_digest_size, &outputMAC, output_digest_size, &Ki, &auth_tag_message);
-                    printf("\n outputMAC:\n ");
-                    OCT_output(&outputMAC);
-
-                    //SETTING UP B.F.
-                    int z = MAX_SLOTS_DATA_SIZE - (output_digest_size+key_size+application_meta_size);
-                    int k = log(2) * (z / number_of_messages);
-                    BloomFilter bloomf(z*8, k);
-                    
-                    std::string bf = ais[message_count].d.message.substr( ais[message_count].d.message.length() - (z*8), z*8);
-                 //   std::cout<<"\n bf: \n"<<bf;
-                    bloomf.to_bits(bf);
-
-                    for(int j = ais_vector.size(), k = ith_timeslot; j > 0,k>0; j--, k--) {
-                        if ( ais_vector[j-1].d.type == 8)
-                            break;
-                        std::string message = ais_vector[j-1].d.message;
-                        string contains = (bloomf.possiblyContains((const unsigned char *)message.c_str(), message.length())?"true":"false");
-                        std::cout<<"\n Contains ais message 4 received#"<< k <<"\t"<<contains;
-                    }
-
-                    if (!OCT_comp(&K0_recvd, &K0))
-                    {
-                        printf("\n*** Key exchanged Failed\n");
-                        return -1;
-                    }else{
-                        printf("\n*** Key K0 exchanged matches! \n");
-                    }
-                    
-                    if (!OCT_comp(&outputMAC, &outputMAC_recvd))
-                    {
-                        printf("*** MAC tag exchanged Failed\n");
-                        return -1;
-                    }else{
-                        printf("*** MAC tag matches! \n");
-                    }
-                    ith_timeslot = 0;
 
+            //fragments are held back, the record of the last one becomes the whole message
+            caesar_reassembly_advance(&reassembly, now);
+            if(caesar_reassembly_add(&reassembly, &msg) > 0) {
+                msg.slot = now;
+                shards[msg.src_mmsi % RECEIVER_VERIFIERS]->push(msg);
             }
-            else if((security_level == 5 || security_level == 6  || security_level == 7) && ais[message_count].d.appmeta_bits==0){
 
-                    nextBloomf = true;
+            if (n % RECEIVER_METRICS_FRAMES == 0)
+                print_queue_metrics(*frames, shards, scheduler, budget);
+        }
+    });
+
+    std::vector<std::thread> verifiers;
+    for (int i = 0; i < RECEIVER_VERIFIERS; i++) {
+        verifiers.emplace_back([&, i]{
+            //decoded records live in the arena of this thread, the TESLA buffer of its shard points into it
+            AisArena &history = ais_thread_arena();
+            TeslaBuffer tesla_buffer(RECEIVER_TESLA_DISCLOSURE_DELAY, RECEIVER_TESLA_EXPIRY_SLOTS, RECEIVER_TESLA_MAX_WAITING);
+            std::vector<ais_message_t *> expired;
+            std::vector<VerifyJob *> finished;
+            //verdicts of the messages of this shard and of the jobs this verifier finishes
+            ais_verdict_stream_t verdicts;
+            ais_verdicts_open(&verdicts, RECEIVER_VERDICT_SOCKET);
+            unsigned idle = 0;
+            while (true) {
+                bool busy = false;
+                ais_message_t &msg = *history.acquire();
+                if (shards[i]->try_pop(msg)) {
+                    //Add element to the history, released once no interval or job refers to it
+                    history.commit();
+
+                    //intervals whose key did not come in time
+                    expired.clear();
+                    tesla_buffer.expire(msg.slot, expired);
+                    retire_records(expired, AIS_AUTH_UNVERIFIED, &verdicts);
+
+                    //published as pending first, consumers do not wait for the verification
+                    msg.auth = AIS_AUTH_PENDING;
+                    ais_verdicts_add(&verdicts, &msg, AIS_AUTH_PENDING);
+
+                    VerifyJob *job = verify_message(msg, tesla_buffer, K0, budget, &verdicts, i);
+                    if (job)
+                        scheduler.push(i, job);
+                    busy = true;
+                }
 
-            }
-            else if((security_level == 5 || security_level == 6  || security_level == 7) && ais[message_count].d.appmeta_bits==1 ){
-                
-                int j = ais_vector.size() - 1; //previous message is TESLA
-                std::string TESLA = std::string(ais_vector[j].d.payload_buffer);
-                TESLA = bintohex(TESLA);
-
-                OCT_fromHex(&Ki, (char *) TESLA.substr(0, key_size*2).data()); 
-                printf("\n Ki:\n ");
-                OCT_output(&Ki);
-
-                //Key verification
-                generateKeyChainCommit(&Ki, &K0_recvd, ith_timeslot, key_size);
-
-                printf("\n Ki(Hi(Ki)) == K0? :\n");
-                OCT_output(&K0_recvd);
-
-
-                OCT_fromHex(&outputMAC_recvd, (char *) TESLA.substr(key_size*2, output_digest_size*2).data()); 
-                printf("\n outputMAC_recvd:\n ");
-                OCT_output(&outputMAC_recvd);
-
-                HMAC(MC_SHA2, input_digest_size, &outputMAC, output_digest_size, &Ki, &auth_tag_message);
-                printf("\n outputMAC:\n ");
-                OCT_output(&outputMAC);
-
-                //SETTING UP B.F.
-                int z = MAX_SLOTS_DATA_SIZE - application_meta_size;
-                int k = log(2) * (z / number_of_messages);
-                BloomFilter bloomf(z*8, k);
-                
-                std::string bf = std::string(ais[message_count].d.payload_buffer).substr(0,  std::string::npos);
-                   
-                bloomf.to_bits(bf);
-
-                for(int j = ais_vector.size()-1, k = ith_timeslot; j >= 0,k>0; j--, k--) {
-                    if ( ais_vector[j].d.type == 8 && ais_vector[j].d.appmeta_bits==1 && ais_vector[j].d.security_level >= 5 ){
-                        break;
-                    }
-                    else if ( ais_vector[j].d.type == 8 && ais_vector[j].d.appmeta_bits==0 && ais_vector[j].d.security_level >= 5 ){
-                        continue;
+                //one task between two messages: a chain chunk, an HMAC or a B.F. check
+                VerifyJob *job;
+                if (scheduler.pop(i, job)) {
+                    if (!job->run(&verdicts)) {
+                        scheduler.push_resumed(i, job);
+                    } else if (job->m_owner == i) {
+                        finished.push_back(job);
+                    } else {
+                        SettledJobs &owner = *settled[job->m_owner];
+                        std::lock_guard<std::mutex> lock(owner.lock);
+                        owner.jobs.push_back(job);
+                        owner.count.fetch_add(1, std::memory_order_release);
                     }
-                    else if ( security_level <5 && ais_vector[j].d.type == 8  ){
-                        break;
-                    }
-                    std::string message = ais_vector[j].d.message;
-
-                    //auto start = std::chrono::high_resolution_clock::now();
-                    string contains = (bloomf.possiblyContains((const unsigned char *)message.c_str(), message.length())?"true":"false");
-                    std::cout<<"\n Contains ais message 4 received#"<< k <<"\t"<<contains;
-                    //auto elapsed = std::chrono::high_resolution_clock::now() - start;
-                    //long long nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
-                    //printf("\nTime taken to check if element in B.F. : %lld nanoseconds\n\n",  nanoseconds);
-                    
+                    busy = true;
+                }
+
+                //outcome of the jobs of this verifier into its TESLA buffer, the next disclosure of the MMSI starts
+                if (settled[i]->count.load(std::memory_order_acquire) > 0) {
+                    std::lock_guard<std::mutex> lock(settled[i]->lock);
+                    finished.insert(finished.end(), settled[i]->jobs.begin(), settled[i]->jobs.end());
+                    settled[i]->jobs.clear();
+                    settled[i]->count.store(0, std::memory_order_relaxed);
+                }
+                for (VerifyJob *done : finished) {
+                    VerifyJob *next = settle_disclosure(done->m_mmsi, !done->m_failed, tesla_buffer, K0, budget, &verdicts, i);
+                    if (next)
+                        scheduler.push(i, next);
+                    //a failed epoch went back to the TESLA buffer, the disclosure is done either way
+                    if (!done->m_failed)
+                        release_records(done->m_epoch);
+                    release_records(done->m_disclosure);
+                    delete done;
                 }
+                finished.clear();
 
-                if (!OCT_comp(&K0_recvd, &K0))
-                {
-                    printf("\n*** Key exchanged Failed\n");
-                    return -1;
-                }else{
-                    printf("\n*** Key K0 exchanged matches! \n");
+                if (busy) {
+                    idle = 0;
+                    continue;
                 }
-                
-                if (!OCT_comp(&outputMAC, &outputMAC_recvd))
-                {
-                    printf("*** MAC tag exchanged Failed\n");
-                    return -1;
-                }else{
-                    printf("*** MAC tag matches! \n");
+                //nothing to do: send the verdicts batched so far, make sure everything makes it to the output, then back off
+                if (idle++ == 0) {
+                    ais_verdicts_flush(&verdicts);
+                    fflush(stdout);
                 }
-                ith_timeslot = 0;
-                
-                nextBloomf = false;
-            }else{
-                //Separate Bloomfilter message
+                else if (idle >= 1024)
+                    usleep(100);
+                else if (idle >= 64)
+                    std::this_thread::yield();
             }
-            
-        
-        }else if(ais[message_count].d.type == 4 ){
-    
-            //increment ith_timeslot everytime ais message is received/simulating one ais slot has passed
-            ith_timeslot++;
-        
-        }
-        //Add element to vector
-        ais_vector.push_back(ais[message_count]);
+        });
+    }
 
+    pin_thread(reader, 0);
+    pin_thread(decoder, 1);
+    for (int i = 0; i < RECEIVER_VERIFIERS; i++)
+        pin_thread(verifiers[i], 2 + i);
 
-        // make sure everything makes it to the output
-        fflush(stdout);         
-    }
+    reader.join();
+    decoder.join();
+    for (auto &t : verifiers)
+        t.join();
+    return 0;
 }